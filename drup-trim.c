@@ -34,7 +34,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #define ERROR      -1
 
 struct solver { FILE *inputFile, *proofFile, *coreFile, *lemmaFile, *traceFile;
-    int *DB, nVars, nClauses, timeout, mask, delete, *falseStack, *false, *forced,
+    int *DB, nVars, nClauses, timeout, mask, delete, binMode, *falseStack, *false, *forced,
         *processed, *assigned, count, *base, *used, *max, *delinfo;
     struct timeval start_time;
     long mem_used, start, time, adsize, adlemmas, *reason, lemmas, arcs;  };
@@ -369,6 +369,25 @@ long matchClause (struct solver* S, long *clauselist, int listsize, int* marks,
   return 0;
 }
 
+int readBinaryLit (FILE *file, int *lit) {
+  unsigned int u = 0, shift = 0;
+  int c;
+  do {
+    if ((c = getc_unlocked (file)) == EOF) return EOF;
+    u |= (unsigned int) (c & 127) << shift;
+    shift += 7; }
+  while (c & 128);
+  *lit = (u & 1) ? -(int) (u >> 1) : (int) (u >> 1);
+  return 1; }
+
+int isBinaryProof (FILE *file) {     // Look for bytes that cannot occur in a text proof.
+  int i, c, bin = 0;
+  for (i = 0; i < 10 && (c = getc_unlocked (file)) != EOF; i++)
+    if ((c != 10) && (c != 13) && (c != 32) && (c != 45) && ((c < 48) || (c > 57)) && (c != 'c') && (c != 'd'))
+      bin = 1;
+  rewind (file);
+  return bin; }
+
 int parse (struct solver* S) {
   int tmp;
   int del, mark, *marks;
@@ -435,6 +454,14 @@ int parse (struct solver* S) {
     int lit = 0; tmp = 0;
     fileSwitchFlag = nZeros <= 0;
 
+    if (fileSwitchFlag && S->binMode) {        // Binary DRAT: 'a' or 'd', then variable-length literals.
+      if (size == 0) {
+        int c = getc_unlocked (S->proofFile);
+        if (c == EOF) break;
+        if (c != 'a' && c != 'd') { printf("c illegal byte %i in binary proof\n", c); exit(1); }
+        del = c == 'd'; }
+      if (readBinaryLit (S->proofFile, &lit) == EOF) { printf("c unexpected end of binary proof\n"); exit(1); } }
+    else {
     if (size == 0) {
       if (!fileSwitchFlag) tmp = fscanf (S->inputFile, " d  %i ", &lit);
       else tmp = fscanf (S->proofFile, " d  %i ", &lit);
@@ -445,7 +472,7 @@ int parse (struct solver* S) {
       if (!fileSwitchFlag) tmp = fscanf (S->inputFile, " %i ", &lit);  // Read a literal.
       else tmp = fscanf (S->proofFile, " %i ", &lit);
       if (tmp == EOF && !fileSwitchFlag) fileSwitchFlag = 1; }
-    if (tmp == EOF && fileSwitchFlag) break;
+    if (tmp == EOF && fileSwitchFlag) break; }
     if (abs(lit) > n) { printf("c illegal literal %i due to max var %i\n", lit, n); exit(1); }
     if (!lit) {
       unsigned int hash = getHash (marks, ++mark, buffer, size);
@@ -526,6 +553,7 @@ int main (int argc, char** argv) {
   S.timeout   = TIMEOUT;
   S.mask      = 0;
   S.delete    = 1;
+  S.binMode   = 0;
   gettimeofday(&S.start_time, NULL);
 
   int i, tmp = 0;
@@ -543,7 +571,7 @@ int main (int argc, char** argv) {
         printf("  -p          run in plain mode (i.e., ignore deletion information)\n\n");
         printf("and input and proof are specified as follows\n\n");
         printf("  INPUT       input file in DIMACS format\n");
-        printf("  PROOF       proof file in DRUP format (stdin if no argument)\n\n");
+        printf("  PROOF       proof file in DRUP format, text or binary (stdin if no argument)\n\n");
         exit(0);
       }
       if (argv[i][1] == 'c') S.coreFile  = fopen (argv[++i], "w");
@@ -569,6 +597,7 @@ int main (int argc, char** argv) {
     }
   }
   if (tmp == 1) printf("c reading proof from stdin\n");
+  else if ((S.binMode = isBinaryProof (S.proofFile))) printf("c turning on binary mode checking\n");
 
   int parseReturnValue = parse(&S);
 
@@ -0,0 +1,197 @@
+/************************************************************************************[lrat-check.c]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+// A checker for (text) LRAT proofs of unsatisfiability.
+//
+// The clauses of the DIMACS input get the IDs 1, 2, ... in file order. Every lemma 'id lits 0 hints 0'
+// is checked by unit propagation over exactly its hints, in the given order: under the negation of
+// the lemma each hint must become unit (its remaining literal is then assigned) until the last one
+// is falsified. This takes time linear in the size of the proof. Only a lemma without any hints
+// (e.g. a clause that the solver got from an external propagator) is checked by propagating over
+// all active clauses. RAT steps (negative hints) are not supported.
+//
+// Exit code: 0 if the proof derives the empty clause, 1 otherwise.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef long long id_t_;
+
+static int     nVars;
+static int**   clause;           // Clause by ID: clause[id][0] is the size, the literals follow (NULL if not active).
+static id_t_   nIds;             // Capacity of 'clause'.
+static id_t_   maxId;            // Largest ID seen so far.
+static signed char* val;         // Truth value of each literal (indexed from -nVars to nVars).
+static int*    trail;
+static int     trailSize;
+static int*    buf;              // Literals of the clause being read.
+static int     bufSize, bufCap;
+static id_t_*  hints;
+static int     hintsSize, hintsCap;
+
+static void die (const char* msg, id_t_ id) {
+  printf("c error: %s (clause %lld)\ns NOT VERIFIED\n", msg, id);
+  exit(1); }
+
+// Reads the next integer, or returns 0 with '*eof' set at the end of the file. The single
+// character 'd' (deletion) is returned as 'D'.
+enum { D = -0x7fffffff };
+static id_t_ readNum (FILE* f, int* eof) {
+  int c;
+  for (;;) {
+    c = getc_unlocked(f);
+    if (c == 'c') { while (c != '\n' && c != EOF) c = getc_unlocked(f); }
+    else if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break; }
+  if (c == EOF) { *eof = 1; return 0; }
+  if (c == 'd') return D;
+  int neg = c == '-';
+  if (neg) c = getc_unlocked(f);
+  if (c < '0' || c > '9') die("unexpected character", maxId);
+  id_t_ x = 0;
+  for (; c >= '0' && c <= '9'; c = getc_unlocked(f)) x = x * 10 + (c - '0');
+  return neg ? -x : x; }
+
+static void pushLit (int lit) {
+  if (bufSize == bufCap) { bufCap = bufCap * 2 + 16; buf = realloc(buf, sizeof(int) * bufCap); }
+  buf[bufSize++] = lit; }
+
+static void pushHint (id_t_ h) {
+  if (hintsSize == hintsCap) { hintsCap = hintsCap * 2 + 16; hints = realloc(hints, sizeof(id_t_) * hintsCap); }
+  hints[hintsSize++] = h; }
+
+static void store (id_t_ id) {
+  if (id <= maxId) die("clause IDs must increase", id);
+  maxId = id;
+  if (id >= nIds) {
+    id_t_ n = nIds;
+    while (nIds <= id) nIds = nIds * 2 + 1024;
+    clause = realloc(clause, sizeof(int*) * nIds);
+    for (; n < nIds; n++) clause[n] = NULL; }
+  int* c = malloc(sizeof(int) * (bufSize + 1));
+  c[0] = bufSize;
+  for (int i = 0; i < bufSize; i++) c[i + 1] = buf[i];
+  clause[id] = c; }
+
+static void assign (int lit) { val[lit] = 1; val[-lit] = -1; trail[trailSize++] = lit; }
+
+static void backtrack () {
+  while (trailSize > 0) { int lit = trail[--trailSize]; val[lit] = val[-lit] = 0; } }
+
+// Returns -1 if 'c' is falsified, 1 if it was unit (its literal is then assigned) and 0 otherwise.
+static int propagateClause (const int* c) {
+  int unit = 0;
+  for (int i = 1; i <= c[0]; i++) {
+    int lit = c[i];
+    if (val[lit] > 0) return 0;
+    if (val[lit] == 0) {
+      if (unit != 0 && unit != lit) return 0;
+      unit = lit; } }
+  if (unit == 0) return -1;
+  assign(unit);
+  return 1; }
+
+// Checks that the lemma in 'buf' follows from its hints (or, without hints, from all active clauses).
+static int check (id_t_ id) {
+  int ok = 0;
+  for (int i = 0; i < bufSize; i++) {
+    int lit = buf[i];
+    if (abs(lit) > nVars) die("illegal literal", id);
+    if (val[lit] > 0) { ok = 1; break; }   // (tautology)
+    if (val[lit] == 0) assign(-lit); }
+
+  if (!ok && hintsSize > 0) {
+    for (int i = 0; i < hintsSize && !ok; i++) {
+      id_t_ h = hints[i];
+      if (h <= 0) die("RAT hints are not supported", id);
+      if (h >= nIds || clause[h] == NULL) die("hint is not an active clause", id);
+      int r = propagateClause(clause[h]);
+      if      (r < 0) ok = 1;
+      else if (r == 0) die("hint clause is not unit", id); } }
+  else if (!ok) {
+    for (int changed = 1; changed && !ok; ) {
+      changed = 0;
+      for (id_t_ h = 1; h <= maxId && h < nIds && !ok; h++)
+        if (clause[h] != NULL) {
+          int r = propagateClause(clause[h]);
+          if      (r < 0) ok = 1;
+          else if (r > 0) changed = 1; } } }
+
+  backtrack();
+  return ok; }
+
+int main (int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage: lrat-check INPUT PROOF\n\n");
+    printf("  INPUT       input file in DIMACS format\n");
+    printf("  PROOF       proof file in (text) LRAT format\n");
+    return 1; }
+
+  FILE* in = fopen(argv[1], "r");
+  if (in == NULL) { printf("c error opening \"%s\".\n", argv[1]); return 1; }
+  FILE* proof = fopen(argv[2], "r");
+  if (proof == NULL) { printf("c error opening \"%s\".\n", argv[2]); return 1; }
+
+  // Header:
+  int c, nClauses = 0;
+  while ((c = getc_unlocked(in)) == 'c' || c == '\n' || c == '\r' || c == ' ')
+    if (c == 'c') while ((c = getc_unlocked(in)) != '\n' && c != EOF);
+  if (c != 'p' || fscanf(in, " cnf %i %i", &nVars, &nClauses) != 2) { printf("c error: no DIMACS header\n"); return 1; }
+
+  val   = (signed char*) calloc(2 * nVars + 1, 1) + nVars;
+  trail = malloc(sizeof(int) * (nVars + 1));
+
+  // Input clauses:
+  int eof = 0, trivial = 0;
+  id_t_ id = 0;
+  while (id < nClauses) {
+    id_t_ lit = readNum(in, &eof);
+    if (eof) break;
+    if (lit == 0) { store(++id); trivial |= bufSize == 0; bufSize = 0; }
+    else if (lit == D || lit > nVars || -lit > nVars) die("illegal literal in input", id + 1);
+    else pushLit((int)lit); }
+  fclose(in);
+  printf("c parsed %lld input clauses over %i variables\n", id, nVars);
+  if (trivial) { printf("s VERIFIED\n"); return 0; }
+
+  // Proof:
+  long lemmas = 0, deletions = 0;
+  for (;;) {
+    id = readNum(proof, &eof);
+    if (eof) break;
+    id_t_ x = readNum(proof, &eof);
+    if (eof) die("unexpected end of proof", id);
+    if (x == D) {
+      while ((x = readNum(proof, &eof)) != 0 && !eof) {
+        if (x < 0 || x >= nIds || clause[x] == NULL) die("deleted clause is not active", x);
+        free(clause[x]); clause[x] = NULL;
+        deletions++; }
+      continue; }
+
+    bufSize = hintsSize = 0;
+    for (; x != 0 && !eof; x = readNum(proof, &eof)) pushLit((int)x);
+    while ((x = readNum(proof, &eof)) != 0 && !eof) pushHint(x);
+    if (eof) die("unexpected end of proof", id);
+
+    if (!check(id)) die("lemma does not follow from its hints", id);
+    store(id);
+    lemmas++;
+    if (bufSize == 0) {
+      printf("c checked %ld lemmas and %ld deletions\ns VERIFIED\n", lemmas, deletions);
+      return 0; } }
+
+  printf("c checked %ld lemmas and %ld deletions, but no empty clause\ns NOT VERIFIED\n", lemmas, deletions);
+  return 1; }
@@ -45,7 +45,7 @@ static void readClause(B& in, Solver& S, vec<Lit>& lits) {
 }
 
 template<class B, class Solver>
-static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false) {
+static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false, bool presize = false) {
     vec<Lit> lits;
     int vars    = 0;
     int clauses = 0;
@@ -57,6 +57,9 @@ static void parse_DIMACS_main(B& in, Solver& S, bool strictp = false) {
             if (eagerMatch(in, "p cnf")){
                 vars    = parseInt(in);
                 clauses = parseInt(in);
+                if (presize)
+                    S.reserveVars(vars);         // (the variables are still created as they occur)
+                S.reserveOriginalIds(clauses);   // (LRAT: derived clauses are numbered after the input)
                 // SATRACE'06 hack
                 // if (clauses > 4000000)
                 //     S.eliminate(true);
@@ -81,6 +84,16 @@ static void parse_DIMACS(gzFile input_stream, Solver& S, bool strictp = false) {
     StreamBuffer in(input_stream);
     parse_DIMACS_main(in, S, strictp); }
 
+// Inserts problem into solver, reading the (uncompressed) file through a memory mapping. Returns
+// FALSE without reading anything if the file can not be mapped; use the 'gzFile' version then.
+//
+template<class Solver>
+static bool parse_DIMACS_mapped(const char* file, Solver& S, bool strictp = false) {
+    MappedBuffer in(file);
+    if (!in.valid()) return false;
+    parse_DIMACS_main(in, S, strictp, true);
+    return true; }
+
 //=================================================================================================
 }
 
@@ -19,6 +19,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 **************************************************************************************************/
 
 #include <math.h>
+#include <chrono>
 
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/Sort.h"
@@ -38,13 +39,41 @@ static DoubleOption  opt_clause_decay      (_cat, "cla-decay",   "The clause act
 static DoubleOption  opt_random_var_freq   (_cat, "rnd-freq",    "The frequency with which the decision heuristic tries to choose a random variable", 0, DoubleRange(0, true, 1, true));
 static DoubleOption  opt_random_seed       (_cat, "rnd-seed",    "Used by the random variable selection",         91648253, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption     opt_ccmin_mode        (_cat, "ccmin-mode",  "Controls conflict clause minimization (0=none, 1=basic, 2=deep)", 2, IntRange(0, 2));
+static IntOption     opt_bin_min_lbd       (_cat, "bin-min-lbd", "Also minimize learnt clauses up to this LBD by the binary clauses of the asserting literal (0=off)", 6, IntRange(0, INT32_MAX));
+static BoolOption    opt_implicit_bins     (_cat, "implicit-bins","Keep binary clauses in dedicated watch lists outside the clause arena", true);
 static IntOption     opt_phase_saving      (_cat, "phase-saving", "Controls the level of phase saving (0=none, 1=limited, 2=full)", 2, IntRange(0, 2));
 static BoolOption    opt_rnd_init_act      (_cat, "rnd-init",    "Randomize the initial activity", false);
 static BoolOption    opt_luby_restart      (_cat, "luby",        "Use the Luby restart sequence", true);
 static IntOption     opt_restart_first     (_cat, "rfirst",      "The base restart interval", 100, IntRange(1, INT32_MAX));
 static DoubleOption  opt_restart_inc       (_cat, "rinc",        "Restart interval increase factor", 2, DoubleRange(1, false, HUGE_VAL, false));
+static BoolOption    opt_ema_restart       (_cat, "ema-restart", "Restart based on moving averages of learnt clause LBD (Glucose style)", false);
+static DoubleOption  opt_restart_margin    (_cat, "rmargin",     "Restart when the fast LBD average exceeds the slow one by this factor", 1.25, DoubleRange(1, true, HUGE_VAL, false));
+static DoubleOption  opt_restart_block     (_cat, "rblock",      "Postpone restarts when the trail exceeds its average by this factor", 1.4, DoubleRange(1, true, HUGE_VAL, false));
+static BoolOption    opt_stable            (_cat, "stable",      "Alternate between focused and stable search modes", false);
+static BoolOption    opt_mode_ticks        (_cat, "mode-ticks",  "Measure the length of search modes in propagation ticks", false);
+static IntOption     opt_mode_init         (_cat, "mode-init",   "The number of conflicts of the first focused mode", 1000, IntRange(1, INT32_MAX));
+static IntOption     opt_stable_restart    (_cat, "stable-rfirst", "The base restart interval in stable mode", 1024, IntRange(1, INT32_MAX));
+static IntOption     opt_rephase_int       (_cat, "rephase-int", "The base number of conflicts between rephasing (0=off)", 1000, IntRange(0, INT32_MAX));
+static BoolOption    opt_binary_proof      (_cat, "binary-proof", "Write the proof in binary DRAT format", false);
+static BoolOption    opt_lrat              (_cat, "lrat",        "Write the proof in LRAT format (clause IDs and antecedents)", false);
+static BoolOption    opt_async_proof       (_cat, "proof-thread","Encode and write the proof on a separate thread", false);
+static IntOption     opt_vmtf              (_cat, "vmtf",        "Decide with the VMTF queue instead of VSIDS (0=never, 1=in focused mode, 2=always)", 0, IntRange(0, 2));
+static IntOption     opt_ext_prop_int      (_cat, "ext-prop-int","Ask the external propagator during unit propagation after this many assignments of observed variables (0=off)", 0, IntRange(0, INT32_MAX));
+static IntOption     opt_chrono            (_cat, "chrono",      "Backtrack chronologically when the backjump would undo more levels than this (0=off)", 0, IntRange(0, INT32_MAX));
+static IntOption     opt_inprocess_int     (_cat, "inproc-int",  "The base number of conflicts between inprocessing rounds (0=off)", 0, IntRange(0, INT32_MAX));
+static BoolOption    opt_inprocess_ticks   (_cat, "inproc-ticks","Measure the intervals between inprocessing rounds in propagation ticks", false);
+static DoubleOption  opt_inprocess_frac    (_cat, "inproc-frac", "The maximal fraction of the search time spent on inprocessing", 0.1, DoubleRange(0, true, 1, true));
+static BoolOption    opt_probe             (_cat, "probe",       "Probe the roots of the binary implication graph during inprocessing", true);
+static DoubleOption  opt_probe_effort      (_cat, "probe-eff",   "The probing effort relative to the search since the last round (in propagation ticks)", 0.2, DoubleRange(0, true, HUGE_VAL, false));
+static IntOption     opt_probe_hbr         (_cat, "probe-hbr",   "The maximal number of hyper-binary resolvents added per probing round", 1000, IntRange(0, INT32_MAX));
+static BoolOption    opt_vivify            (_cat, "vivify",      "Vivify the core and tier-2 learnt clauses and the problem clauses during inprocessing", true);
+static DoubleOption  opt_vivify_effort     (_cat, "vivify-eff",  "The vivification effort on learnt clauses relative to the search since the last round (in propagation ticks)", 0.1, DoubleRange(0, true, HUGE_VAL, false));
+static DoubleOption  opt_vivify_irred      (_cat, "vivify-irr-eff", "The vivification effort on problem clauses relative to the search since the last round (in propagation ticks)", 0.05, DoubleRange(0, true, HUGE_VAL, false));
 static DoubleOption  opt_garbage_frac      (_cat, "gc-frac",     "The fraction of wasted memory allowed before a garbage collection is triggered",  0.20, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption     opt_min_learnts_lim   (_cat, "min-learnts", "Minimum learnt clause limit",  0, IntRange(0, INT32_MAX));
+static IntOption     opt_core_lbd          (_cat, "core-lbd",    "Learnt clauses with at most this LBD are never deleted", 2, IntRange(0, INT32_MAX));
+static IntOption     opt_tier2_lbd         (_cat, "tier2-lbd",   "Learnt clauses with at most this LBD are kept while they are used", 6, IntRange(0, INT32_MAX));
+static IntOption     opt_tier2_interval    (_cat, "tier2-int",   "Conflicts between demotions of unused tier-2 learnt clauses", 10000, IntRange(1, INT32_MAX));
 
 
 //=================================================================================================
@@ -62,6 +91,9 @@ Solver::Solver() :
   , random_seed      (opt_random_seed)
   , luby_restart     (opt_luby_restart)
   , ccmin_mode       (opt_ccmin_mode)
+  , bin_min_lbd      (opt_bin_min_lbd)
+  , bin_min_size     (30)
+  , use_implicit_bins(opt_implicit_bins)
   , phase_saving     (opt_phase_saving)
   , rnd_pol          (false)
   , rnd_init_act     (opt_rnd_init_act)
@@ -69,6 +101,28 @@ Solver::Solver() :
   , min_learnts_lim  (opt_min_learnts_lim)
   , restart_first    (opt_restart_first)
   , restart_inc      (opt_restart_inc)
+  , ema_restart      (opt_ema_restart)
+  , restart_margin   (opt_restart_margin)
+  , restart_block    (opt_restart_block)
+  , restart_min_confl  (50)
+  , restart_block_start(10000)
+  , stable_enabled   (opt_stable)
+  , mode_ticks       (opt_mode_ticks)
+  , mode_init        (opt_mode_init)
+  , stable_restart_first(opt_stable_restart)
+  , rephase_int      (opt_rephase_int)
+  , vmtf_mode        (opt_vmtf)
+  , chrono           (opt_chrono)
+  , ext_prop_int     (opt_ext_prop_int)
+  , inprocess_int    (opt_inprocess_int)
+  , inprocess_ticks  (opt_inprocess_ticks)
+  , inprocess_frac   (opt_inprocess_frac)
+  , probe_enabled    (opt_probe)
+  , probe_effort     (opt_probe_effort)
+  , probe_hbr_lim    (opt_probe_hbr)
+  , vivify_enabled   (opt_vivify)
+  , vivify_effort    (opt_vivify_effort)
+  , vivify_irred_effort(opt_vivify_irred)
 
     // Parameters (the rest):
     //
@@ -79,6 +133,10 @@ Solver::Solver() :
   , learntsize_adjust_start_confl (100)
   , learntsize_adjust_inc         (1.5)
 
+  , core_lbd         (opt_core_lbd)
+  , tier2_lbd        (opt_tier2_lbd)
+  , tier2_interval   (opt_tier2_interval)
+
     // Statistics: (formerly in 'SolverStats')
     //
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
@@ -86,6 +144,11 @@ Solver::Solver() :
 
   , watches            (WatcherDeleted(ca))
   , order_heap         (VarOrderLt(activity))
+  , vmtf_first         (var_Undef)
+  , vmtf_last          (var_Undef)
+  , vmtf_unassigned    (var_Undef)
+  , vmtf_time          (0)
+  , vmtf_active        (false)
   , ok                 (true)
   , cla_inc            (1)
   , var_inc            (1)
@@ -94,18 +157,151 @@ Solver::Solver() :
   , simpDB_props       (0)
   , progress_estimate  (0)
   , remove_satisfied   (true)
+  , implicit_bins      (use_implicit_bins)
   , next_var           (0)
+  , lbd_ema_fast       (1.0 / 32)
+  , lbd_ema_slow       (1.0 / 16384)
+  , trail_ema          (1.0 / 4096)
+  , target_assigned    (0)
+  , best_assigned      (0)
+  , stable             (false)
+  , mode_start_conflicts(0)
+  , mode_start_ticks   (0)
+  , mode_unit          (0)
+  , stable_restarts    (0)
+  , next_rephase       (0)
+  , next_inprocess     (0)
+  , inprocess_unit     (0)
+  , inprocess_rounds   (0)
+  , search_time        (0)
+  , probe_next         (0)
+  , probe_ticks        (0)
+  , vivify_ticks       (0)
 
     // Resource constraints:
     //
   , conflict_budget    (-1)
   , propagation_budget (-1)
   , asynch_interrupt   (false)
-{}
+
+  , binary_proof       (opt_binary_proof)
+  , lrat               (opt_lrat)
+  , async_proof        (opt_async_proof)
+{
+    num_tier[tier_core] = num_tier[tier_two] = num_tier[tier_local] = 0;
+    ticks = mode_switches = rephases = inprocessings = 0;
+    inprocess_time = 0;
+    probes = failed_lits = hyper_bins = 0;
+    vivified = vivified_lits = 0;
+    lbd_stamp = 0;
+    bin_min_time = 0;
+
+    // Every clause an LRAT proof refers to must carry its ID, so binaries stay in the arena:
+    if (lrat){
+        ca.clause_ids     = true;
+        use_implicit_bins = implicit_bins = false; }
+}
 
 
 Solver::~Solver()
 {
+    if (ring != NULL)
+        stopProofThread();
+    else
+        writeBuffer();
+}
+
+
+//=================================================================================================
+// Proof output:
+
+
+void Solver::outputFlush()
+{
+    if (ring == NULL){
+        writeBuffer();
+        return; }
+
+    ringReserve(1);
+    ringPush(op_flush);
+    ringPublish();
+    while (ring_tail.load(std::memory_order_acquire) != ring_local)
+        std::this_thread::yield();
+}
+
+
+void Solver::writeBuffer()
+{
+    FILE* f = ring != NULL ? proof_file : output;
+    if (f != NULL && output_used > 0)
+        fwrite((char*)output_buf, 1, output_used, f);
+    output_used = 0;
+    output_buf.growTo(output_buf_size);
+}
+
+
+void Solver::startProofThread()
+{
+    assert(ring == NULL);
+    ring         = new uint32_t[ring_size];
+    ring_file    = proof_file = NULL;
+    proof_thread = std::thread(&Solver::proofThreadMain, this);
+}
+
+
+// Writes everything queued so far and joins the proof thread.
+void Solver::stopProofThread()
+{
+    ringReserve(1);
+    ringPush(op_stop);
+    ringPublish();
+    proof_thread.join();
+    delete [] ring;
+    ring = NULL;
+}
+
+
+void Solver::proofThreadMain()
+{
+    uint64_t tail  = ring_tail.load(std::memory_order_relaxed);
+    int      spins = 0;
+    for (;;){
+        uint64_t head = ring_head.load(std::memory_order_acquire);
+        if (tail == head){
+            // Nothing queued: spin briefly, then sleep.
+            if (spins++ < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue; }
+
+        spins = 0;
+        while (tail < head){
+            uint32_t w = ring[tail++ & ring_mask];
+            switch (w & 255){
+            case op_begin:    encodeBegin((char)(w >> 8)); break;
+            case op_lit:      encodeLit(toLit(ring[tail++ & ring_mask])); break;
+            case op_end:      encodeEnd(); break;
+            case op_end_line: encodeEndLine(); break;
+            case op_flush:    writeBuffer(); break;
+            case op_num:
+            case op_file:{
+                uint64_t x = ring[tail & ring_mask] | (uint64_t)ring[(tail + 1) & ring_mask] << 32;
+                tail += 2;
+                if ((w & 255) == op_num)
+                    encodeNum(x, w >> 8);
+                else{
+                    writeBuffer();
+                    proof_file = (FILE*)(uintptr_t)x; }
+                break; }
+            case op_stop:
+                writeBuffer();
+                ring_tail.store(tail, std::memory_order_release);
+                return;
+            }
+        }
+        ring_tail.store(tail, std::memory_order_release);
+    }
 }
 
 
@@ -127,19 +323,58 @@ Var Solver::newVar(lbool upol, bool dvar)
 
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    bin_watches.reserve(mkLit(v, true));
+    bin_watches[mkLit(v, false)].clear();
+    bin_watches[mkLit(v, true )].clear();
     assigns  .insert(v, l_Undef);
     vardata  .insert(v, mkVarData(CRef_Undef, 0));
     activity .insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
     seen     .insert(v, 0);
+    bin_min_stamp.insert(v, 0);
     polarity .insert(v, true);
     user_pol .insert(v, upol);
+    target   .insert(v, l_Undef);
+    best     .insert(v, l_Undef);
+    unit_id  .insert(v, 0);
+    observed .insert(v, 0);
+    ext_watched.insert(mkLit(v, false), 0);
+    ext_watched.insert(mkLit(v, true ), 0);
     decision .reserve(v);
     trail    .capacity(v+1);
+    if (!vmtf_stamp.has(v)){
+        // (reused variables keep their place in the queue)
+        vmtf_stamp.insert(v, 0);
+        vmtf_links.insert(v, VmtfLink());
+        vmtfEnqueue(v); }
     setDecisionVar(v, dvar);
     return v;
 }
 
 
+// Grows the per-variable data in one step, instead of geometrically as 'newVar()' is called:
+void Solver::reserveVars(int n)
+{
+    watches    .capacity(2*n);
+    bin_watches.capacity(2*n);
+    assigns    .capacity(n);
+    vardata    .capacity(n);
+    activity   .capacity(n);
+    seen       .capacity(n);
+    bin_min_stamp.capacity(n);
+    polarity   .capacity(n);
+    user_pol   .capacity(n);
+    target     .capacity(n);
+    best       .capacity(n);
+    unit_id    .capacity(n);
+    observed   .capacity(n);
+    ext_watched.capacity(2*n);
+    decision   .capacity(n);
+    vmtf_stamp .capacity(n);
+    vmtf_links .capacity(n);
+    trail      .capacity(n);
+}
+
+
 // Note: at the moment, only unassigned variable will be released (this is to avoid duplicate
 // releases of the same variable).
 void Solver::releaseVar(Lit l)
@@ -152,6 +387,12 @@ void Solver::releaseVar(Lit l)
 
 
 bool Solver::addClause_(vec<Lit>& ps)
+{
+    return addClause_(ps, originalId());
+}
+
+
+bool Solver::addClause_(vec<Lit>& ps, uint64_t id)
 {
     assert(decisionLevel() == 0);
     if (!ok) return false;
@@ -173,7 +414,14 @@ bool Solver::addClause_(vec<Lit>& ps)
 
     // proof output
     if (output) {
-        if (ps.size() != oc.size()) {
+        if (ps.size() != oc.size() && lrat) {
+            lrat_hints.clear();
+            lratUnits(oc, lrat_hints);
+            lrat_hints.push(id);
+            outputLrat(newId(), ps, lrat_hints);
+            outputLratDeleted(id);
+            id = next_id;
+        }else if (ps.size() != oc.size()) {
             outputPrintClause(ps);
             outputPrintClauseDeleted(oc);
         }
@@ -182,10 +430,16 @@ bool Solver::addClause_(vec<Lit>& ps)
     if (ps.size() == 0)
         return ok = false;
     else if (ps.size() == 1){
+        unit_id[var(ps[0])] = id;
         uncheckedEnqueue(ps[0]);
-        return ok = (propagate() == CRef_Undef);
-    }else{
-        CRef cr = ca.alloc(ps, false);
+        CRef confl = propagate();
+        if (confl != CRef_Undef && output && lrat)
+            lratEmptyClause(confl);
+        return ok = (confl == CRef_Undef);
+    }else if (ps.size() == 2 && implicit_bins)
+        attachBinary(ps[0], ps[1], false);
+    else{
+        CRef cr = ca.alloc(ps, false, id);
         clauses.push(cr);
         attachClause(cr);
     }
@@ -199,11 +453,121 @@ void Solver::attachClause(CRef cr){
     assert(c.size() > 1);
     watches[~c[0]].push(Watcher(cr, c[1]));
     watches[~c[1]].push(Watcher(cr, c[0]));
-    if (c.learnt()) num_learnts++, learnts_literals += c.size();
+    if (c.learnt()) num_learnts++, learnts_literals += c.size(), num_tier[c.tier()]++;
     else            num_clauses++, clauses_literals += c.size();
 }
 
 
+void Solver::attachBinary(Lit p, Lit q, bool learnt){
+    assert(p != q);
+    bin_watches[~p].push(BinWatcher(q, learnt));
+    bin_watches[~q].push(BinWatcher(p, learnt));
+    if (learnt) num_learnts++, learnts_literals += 2, num_tier[tier_core]++;
+    else        num_clauses++, clauses_literals += 2;
+}
+
+
+// Moves binary clauses allocated while 'implicit_bins' was off (or shrunk to binaries later) out
+// of the clause arena. This changes only the representation, so nothing is written to the proof.
+//
+void Solver::makeBinariesImplicit(){
+    assert(implicit_bins);
+    for (int pass = 0; pass < 2; pass++){
+        vec<CRef>& cs = pass == 0 ? clauses : learnts;
+        int i, j;
+        for (i = j = 0; i < cs.size(); i++){
+            Clause& c = ca[cs[i]];
+            if (c.mark() == 1 || c.size() != 2){
+                cs[j++] = cs[i];
+                continue; }
+
+            attachBinary(c[0], c[1], c.learnt());
+            if (locked(c))
+                vardata[var(c[0])] = mkVarData(CRef_Bin, level(var(c[0])), c[1]);
+            detachClause(cs[i]);
+            c.mark(1);
+            ca.free(cs[i]);
+        }
+        cs.shrink(i - j);
+    }
+}
+
+
+// The reverse of 'makeBinariesImplicit()' for the problem clauses (learnt binaries stay implicit).
+// The reasons of the level 0 literals keep referring to 'CRef_Bin'.
+//
+void Solver::makeBinariesExplicit(){
+    assert(!implicit_bins);
+    vec<Lit> bin(2);
+    for (int v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++){
+            Lit              p  = mkLit(v, s);
+            vec<BinWatcher>& ws = bin_watches[p];
+            int i, j;
+            for (i = j = 0; i < ws.size(); i++)
+                if (ws[i].learnt)
+                    ws[j++] = ws[i];
+                else if (~p < ws[i].other){
+                    // (the clause is moved when it is met in the list of its smallest literal)
+                    bin[0] = ~p; bin[1] = ws[i].other;
+                    CRef cr = ca.alloc(bin);
+                    clauses.push(cr);
+                    attachClause(cr);
+                    num_clauses--, clauses_literals -= 2;
+                }
+            ws.shrink(i - j);
+        }
+}
+
+// As above, but only for the binary problem clauses containing a variable of 'vs'. Only the lists of
+// these variables are scanned; the lists of the other literals of the moved clauses are just cleaned
+// afterwards.
+//
+void Solver::makeBinariesExplicit(const vec<Var>& vs){
+    assert(!implicit_bins);
+    vec<Lit> bin(2);
+    vec<Var> others;
+    for (int k = 0; k < vs.size(); k++)
+        seen[vs[k]] = 1;
+    for (int k = 0; k < vs.size(); k++)
+        for (int s = 0; s < 2; s++){
+            Lit              p  = mkLit(vs[k], s);
+            vec<BinWatcher>& ws = bin_watches[p];
+            int i, j;
+            for (i = j = 0; i < ws.size(); i++){
+                Lit q = ws[i].other;
+                if (ws[i].learnt)
+                    ws[j++] = ws[i];
+                else if (seen[var(q)] != 1 || ~p < q){
+                    // (between two variables of 'vs', the clause is moved in the list of its smallest literal)
+                    if (seen[var(q)] == 0){
+                        seen[var(q)] = 2;
+                        others.push(var(q)); }
+                    bin[0] = ~p; bin[1] = q;
+                    CRef cr = ca.alloc(bin);
+                    clauses.push(cr);
+                    attachClause(cr);
+                    num_clauses--, clauses_literals -= 2;
+                }
+            }
+            ws.shrink(i - j);
+        }
+    for (int k = 0; k < others.size(); k++)
+        for (int s = 0; s < 2; s++){
+            vec<BinWatcher>& ws = bin_watches[mkLit(others[k], s)];
+            int i, j;
+            for (i = j = 0; i < ws.size(); i++)
+                if (ws[i].learnt || seen[var(ws[i].other)] != 1)
+                    ws[j++] = ws[i];
+            ws.shrink(i - j);
+        }
+    for (int k = 0; k < vs.size(); k++)
+        seen[vs[k]] = 0;
+    for (int k = 0; k < others.size(); k++)
+        seen[others[k]] = 0;
+}
+
+
 void Solver::detachClause(CRef cr, bool strict){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
@@ -217,7 +581,7 @@ void Solver::detachClause(CRef cr, bool strict){
         watches.smudge(~c[1]);
     }
 
-    if (c.learnt()) num_learnts--, learnts_literals -= c.size();
+    if (c.learnt()) num_learnts--, learnts_literals -= c.size(), num_tier[c.tier()]--;
     else            num_clauses--, clauses_literals -= c.size();
 }
 
@@ -226,7 +590,9 @@ void Solver::removeClause(CRef cr) {
     Clause& c = ca[cr];
     // proof print deleted clause
     if (output) {
-        outputPrintClauseDeleted(c);
+        if (lrat && locked(c) && level(var(c[0])) == 0)
+            unitId(var(c[0]));  // (derive the unit clause while its reason is still there)
+        proofDeleted(c);
     }
     detachClause(cr);
     // Don't leave pointers to free'd memory!
@@ -243,12 +609,18 @@ bool Solver::satisfied(const Clause& c) const {
     return false; }
 
 
-// Revert to the state at given level (keeping all assignment at 'level' but not beyond).
+// Revert to the state at given level (keeping all assignment at 'level' but not beyond). Literals
+// assigned out of order at or below 'level' (see 'chrono') stay on the trail, after the others and
+// in their previous order, and are propagated (and notified to the external propagator) again.
 //
 void Solver::cancelUntil(int level) {
     if (decisionLevel() > level){
+        cancel_kept.clear();
         for (int c = trail.size()-1; c >= trail_lim[level]; c--){
             Var      x  = var(trail[c]);
+            if (vardata[x].level <= level){
+                cancel_kept.push(trail[c]);
+                continue; }
             assigns [x] = l_Undef;
             if (phase_saving > 1 || (phase_saving == 1 && c > trail_lim.last()))
                 polarity[x] = sign(trail[c]);
@@ -256,10 +628,15 @@ void Solver::cancelUntil(int level) {
         qhead = trail_lim[level];
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+        for (int i = cancel_kept.size()-1; i >= 0; i--)
+            trail.push_(cancel_kept[i]);
 
         if (external_propagator) {
-            assert(notify_assignment_index >= trail.size());
-            notify_assignment_index = trail.size();
+            assert(notify_assignment_index >= qhead);
+            notify_assignment_index = qhead;
+            if (notify_lim.size() > (size_t)level){
+                notify_trail.resize(notify_lim[level]);
+                notify_lim.resize(level); }
             notify_backtrack = true;
         }
     }
@@ -284,19 +661,27 @@ Lit Solver::pickBranchLit()
         }
     }
 
-    // Random decision:
-    if (drand(random_seed) < random_var_freq && !order_heap.empty()){
-        next = order_heap[irand(random_seed,order_heap.size())];
-        if (value(next) == l_Undef && decision[next])
-            rnd_decisions++; }
-
-    // Activity based decision:
-    while (next == var_Undef || value(next) != l_Undef || !decision[next])
-        if (order_heap.empty()){
-            next = var_Undef;
-            break;
-        }else
-            next = order_heap.removeMin();
+    if (vmtf_active){
+        // Most recently bumped unassigned decision variable:
+        next = vmtf_unassigned;
+        while (next != var_Undef && (value(next) != l_Undef || !decision[next]))
+            next = vmtf_links[next].prev;
+        vmtf_unassigned = next;
+    }else{
+        // Random decision:
+        if (drand(random_seed) < random_var_freq && !order_heap.empty()){
+            next = order_heap[irand(random_seed,order_heap.size())];
+            if (value(next) == l_Undef && decision[next])
+                rnd_decisions++; }
+
+        // Activity based decision:
+        while (next == var_Undef || value(next) != l_Undef || !decision[next])
+            if (order_heap.empty()){
+                next = var_Undef;
+                break;
+            }else
+                next = order_heap.removeMin();
+    }
 
     // Choose polarity based on different polarity modes (global or per-variable):
     if (next == var_Undef)
@@ -305,6 +690,8 @@ Lit Solver::pickBranchLit()
         return mkLit(next, user_pol[next] == l_True);
     else if (rnd_pol)
         return mkLit(next, drand(random_seed) < 0.5);
+    else if (stable && target[next] != l_Undef)
+        return mkLit(next, target[next] == l_False);
     else
         return mkLit(next, polarity[next]);
 }
@@ -312,7 +699,7 @@ Lit Solver::pickBranchLit()
 
 /*_________________________________________________________________________________________________
 |
-|  analyze : (confl : Clause*) (out_learnt : vec<Lit>&) (out_btlevel : int&)  ->  [void]
+|  analyze : (confl : Clause*) (out_learnt : vec<Lit>&) (out_btlevel : int&) (out_lbd : int&)  ->  [void]
 |  
 |  Description:
 |    Analyze conflict and produce a reason clause.
@@ -325,12 +712,16 @@ Lit Solver::pickBranchLit()
 |      * 'out_learnt[0]' is the asserting literal at level 'out_btlevel'.
 |      * If out_learnt.size() > 1 then 'out_learnt[1]' has the greatest decision level of the 
 |        rest of literals. There may be others from the same level though.
+|      * 'out_lbd' is the number of distinct decision levels in 'out_learnt'.
 |  
+|    Learnt clauses taking part in the analysis have their LBD recomputed and may be promoted to
+|    a more persistent tier.
 |________________________________________________________________________________________________@*/
-void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
+void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd)
 {
-    int pathC = 0;
-    Lit p     = lit_Undef;
+    int  pathC       = 0;
+    Lit  p           = lit_Undef;
+    CRef first_confl = confl;
 
     // Generate conflict clause:
     //
@@ -339,12 +730,33 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 
     do{
         assert(confl != CRef_Undef); // (otherwise should be UIP)
-        Clause& c = ca[confl];
-
-        if (c.learnt())
-            claBumpActivity(c);
+        const Lit* c;
+        int        c_size;
+        Lit        bin[2];
+
+        if (confl == CRef_Bin){
+            // Implicit binary clause (either the conflict or the reason for 'p'):
+            c      = p == lit_Undef ? bin_confl : reasonLits(var(p), bin, c_size);
+            c_size = 2;
+        }else{
+            Clause& cl = ca[confl];
+            if (cl.learnt()){
+                claBumpActivity(cl);
+                if (cl.tier() != tier_core){
+                    cl.used(true);
+                    int lbd = computeLBD(cl);
+                    if ((unsigned)lbd < cl.lbd()){
+                        cl.lbd(lbd);
+                        if (lbdTier(lbd) < cl.tier())
+                            setTier(cl, lbdTier(lbd));
+                    }
+                }
+            }
+            c      = cl;
+            c_size = cl.size();
+        }
 
-        for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
+        for (int j = (p == lit_Undef) ? 0 : 1; j < c_size; j++){
             Lit q = c[j];
 
             if (!seen[var(q)] && level(var(q)) > 0){
@@ -357,9 +769,11 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
             }
         }
         
-        // Select next clause to look at:
-        while (!seen[var(trail[index--])]);
-        p     = trail[index+1];
+        // Select next clause to look at (skipping the literals of lower levels assigned out of order):
+        do{
+            while (!seen[var(trail[index--])]);
+            p = trail[index+1];
+        }while (level(var(p)) < decisionLevel());
         confl = reasonLazy(var(p));
         seen[var(p)] = 0;
         pathC--;
@@ -383,8 +797,10 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
             if (reason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
             else{
-                Clause& c = ca[reasonLazy(var(out_learnt[i]))];
-                for (int k = 1; k < c.size(); k++)
+                Lit        bin[2];
+                int        c_size;
+                const Lit* c = reasonLits(x, bin, c_size);
+                for (int k = 1; k < c_size; k++)
                     if (!seen[var(c[k])] && level(var(c[k])) > 0){
                         out_learnt[j++] = out_learnt[i];
                         break; }
@@ -395,6 +811,9 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 
     max_literals += out_learnt.size();
     out_learnt.shrink(i - j);
+    out_lbd = computeLBD(out_learnt);
+    if (out_lbd <= bin_min_lbd && out_learnt.size() <= bin_min_size && binaryMinimize(out_learnt))
+        out_lbd = computeLBD(out_learnt);
     tot_literals += out_learnt.size();
 
     // Find correct backtrack level:
@@ -414,7 +833,48 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         out_btlevel       = level(var(p));
     }
 
+    // Move the bumped variables to the end of the VMTF queue, keeping their relative order:
+    if (vmtf_active){
+        sort(analyze_bumped, VmtfStampLt(vmtf_stamp));
+        for (int i = 0; i < analyze_bumped.size(); i++)
+            vmtfBump(analyze_bumped[i]);
+        analyze_bumped.clear();
+    }
+
     for (int j = 0; j < analyze_toclear.size(); j++) seen[var(analyze_toclear[j])] = 0;    // ('seen[]' is now cleared)
+
+    if (output && lrat)
+        lratChain(first_confl, out_learnt, lrat_hints);
+}
+
+
+// Removes the literals '~q' of a learnt clause for which '(out_learnt[0] \/ q)' is a binary clause
+// (self-subsuming resolution). Only the implicit binaries are looked at, so nothing is removed with
+// LRAT, where there would be no antecedents for it. Returns TRUE if the clause was shortened.
+bool Solver::binaryMinimize(vec<Lit>& out_learnt)
+{
+    // The literals of the clause get the stamp 'bin_min_time', those to remove the one after:
+    bin_min_time += 2;
+    for (int i = 1; i < out_learnt.size(); i++)
+        bin_min_stamp[var(out_learnt[i])] = bin_min_time;
+
+    const vec<BinWatcher>& ws = bin_watches[~out_learnt[0]];
+    int removed = 0;
+    for (int k = 0; k < ws.size(); k++){
+        Lit q = ws[k].other;
+        if (bin_min_stamp[var(q)] == bin_min_time && value(q) == l_True){
+            bin_min_stamp[var(q)] = bin_min_time + 1;
+            removed++; }
+    }
+    if (removed == 0)
+        return false;
+
+    int i, j;
+    for (i = j = 1; i < out_learnt.size(); i++)
+        if (bin_min_stamp[var(out_learnt[i])] != bin_min_time + 1)
+            out_learnt[j++] = out_learnt[i];
+    out_learnt.shrink(i - j);
+    return true;
 }
 
 
@@ -425,14 +885,16 @@ bool Solver::litRedundant(Lit p)
     assert(seen[var(p)] == seen_undef || seen[var(p)] == seen_source);
     assert(reason(var(p)) != CRef_Undef);
 
-    Clause*               c     = &ca[reasonLazy(var(p))];
+    Lit                   bin[2];
+    int                   c_size;
+    const Lit*            c     = reasonLits(var(p), bin, c_size);
     vec<ShrinkStackElem>& stack = analyze_stack;
     stack.clear();
 
     for (uint32_t i = 1; ; i++){
-        if (i < (uint32_t)c->size()){
+        if (i < (uint32_t)c_size){
             // Checking 'p'-parents 'l':
-            Lit l = (*c)[i];
+            Lit l = c[i];
             
             // Variable at level 0 or previously removable:
             if (level(var(l)) == 0 || seen[var(l)] == seen_source || seen[var(l)] == seen_removable){
@@ -454,7 +916,7 @@ bool Solver::litRedundant(Lit p)
             stack.push(ShrinkStackElem(i, p));
             i  = 0;
             p  = l;
-            c  = &ca[reasonLazy(var(p))];
+            c  = reasonLits(var(p), bin, c_size);
         }else{
             // Finished with current element 'p' and reason 'c':
             if (seen[var(p)] == seen_undef){
@@ -468,7 +930,7 @@ bool Solver::litRedundant(Lit p)
             // Continue with top element on stack:
             i  = stack.last().i;
             p  = stack.last().l;
-            c  = &ca[reason(var(p))];
+            c  = reasonLits(var(p), bin, c_size);
 
             stack.pop();
         }
@@ -478,6 +940,188 @@ bool Solver::litRedundant(Lit p)
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  lratChain : (confl : CRef) (c : const vec<Lit>&) (hints : vec<uint64_t>&)  ->  [void]
+|  
+|  Description:
+|    Collect the antecedents of the learnt clause 'c' derived from the conflict 'confl' in
+|    'hints', in an order in which each of them is unit under the negation of 'c' and the
+|    ones before it: the unit clauses of the level 0 literals first, then the reasons of all
+|    literals resolved away by 'analyze()' or removed by 'litRedundant()', every reason after the
+|    reasons of its own literals, and the conflicting clause last.
+|________________________________________________________________________________________________@*/
+void Solver::lratChain(CRef confl, const vec<Lit>& c, vec<uint64_t>& hints)
+{
+    vec<ShrinkStackElem>& stack = analyze_stack;
+    hints.clear();
+    lrat_reasons.clear();
+    for (int i = 0; i < c.size(); i++){
+        seen[var(c[i])] = 1;
+        lrat_toclear.push(var(c[i])); }
+
+    for (int k = 0; k < ca[confl].size(); k++){
+        Lit p = ca[confl][k];
+        if (seen[var(p)]) continue;
+        seen[var(p)] = 1;
+        lrat_toclear.push(var(p));
+        if (level(var(p)) == 0){
+            hints.push(unitId(var(p)));
+            continue; }
+
+        // Depth-first search through the reasons of 'p' (all of them were fetched by the analysis):
+        stack.clear();
+        for (uint32_t i = 1; ; ){
+            assert(reason(var(p)) != CRef_Undef && !isReasonLazy(var(p)));
+            const Clause& r = ca[reason(var(p))];
+            if (i < (uint32_t)r.size()){
+                Lit l = r[i++];
+                if (seen[var(l)]) continue;
+                seen[var(l)] = 1;
+                lrat_toclear.push(var(l));
+                if (level(var(l)) == 0){
+                    hints.push(unitId(var(l)));
+                    continue; }
+                stack.push(ShrinkStackElem(i, p));
+                p = l;
+                i = 1;
+            }else{
+                lrat_reasons.push(r.id());
+                if (stack.size() == 0) break;
+                i = stack.last().i;
+                p = stack.last().l;
+                stack.pop();
+            }
+        }
+    }
+
+    for (int i = 0; i < lrat_reasons.size(); i++)
+        hints.push(lrat_reasons[i]);
+    hints.push(ca[confl].id());
+
+    for (int i = 0; i < lrat_toclear.size(); i++)
+        seen[lrat_toclear[i]] = 0;
+    lrat_toclear.clear();
+}
+
+
+// Returns the ID of the unit clause of 'x', which must be assigned at level 0. The unit clauses of
+// implied literals are derived in trail order, when first needed, from their reasons. These must
+// therefore stay in place until then (see 'lratUnitsDerived()').
+uint64_t Solver::unitId(Var x)
+{
+    assert(value(x) != l_Undef && level(x) == 0);
+    while (unit_id[x] == 0){
+        assert(unit_head < trail.size());
+        Lit p = trail[unit_head++];
+        Var v = var(p);
+        if (unit_id[v] != 0) continue;
+
+        unit_hints.clear();
+        if (isReasonLazy(v)){
+            // The external propagator gives the reason now. It is not needed for anything else:
+            unit_lits.clear();
+            size_t size;
+            const int* lits = external_propagator->cb_add_reason_clause(LitToint(p), size);
+            for (size_t k = 0; k < size; k++)
+                unit_lits.push(intToLit(lits[k]));
+            uint64_t ext = newId();
+            outputLrat(ext, unit_lits, unit_hints);
+            for (int k = 0; k < unit_lits.size(); k++)
+                if (unit_lits[k] != p && find(unit_hints, unit_id[var(unit_lits[k])]) == false)
+                    unit_hints.push(unit_id[var(unit_lits[k])]);
+            unit_hints.push(ext);
+            vardata[v].reason = CRef_Undef;
+        }else{
+            assert(reason(v) != CRef_Undef);
+            const Clause& c = ca[reason(v)];
+            assert(c[0] == p);
+            for (int k = 1; k < c.size(); k++)
+                unit_hints.push(unit_id[var(c[k])]);
+            unit_hints.push(c.id());
+        }
+        unit_id[v] = newId();
+        unit_lits.clear();
+        unit_lits.push(p);
+        outputLrat(unit_id[v], unit_lits, unit_hints);
+    }
+    return unit_id[x];
+}
+
+
+void Solver::lratUnitsDerived()
+{
+    assert(decisionLevel() == 0);
+    for (int i = unit_head; i < trail.size(); i++)
+        unitId(var(trail[i]));
+}
+
+
+void Solver::lratEmptyClause(CRef confl)
+{
+    vec<Lit> empty;
+    lrat_hints.clear();
+    lratUnits(ca[confl], lrat_hints);
+    lrat_hints.push(ca[confl].id());
+    outputLrat(newId(), empty, lrat_hints);
+}
+
+
+uint64_t Solver::proofLemma(const vec<Lit>& c, const vec<uint64_t>& hints)
+{
+    if (output == NULL)
+        return 0;
+    else if (lrat){
+        uint64_t id = newId();
+        outputLrat(id, c, hints);
+        return id; }
+
+    outputPrintClause(c);
+    return 0;
+}
+
+
+void Solver::proofDeleted(const Clause& c)
+{
+    if (output == NULL)
+        return;
+    else if (lrat)
+        outputLratDeleted(c.id());
+    else
+        outputPrintClauseDeleted(c);
+}
+
+
+void Solver::proofDeleted(const vec<Lit>& c, uint64_t id)
+{
+    if (output == NULL)
+        return;
+    else if (lrat)
+        outputLratDeleted(id);
+    else
+        outputPrintClauseDeleted(c);
+}
+
+
+// Writes a clause of the external propagator, whose antecedents are unknown (so it can only be
+// checked by unit propagation), followed by 'ps' if that is shorter (with level 0 literals
+// removed). Returns the ID of the last clause written.
+uint64_t Solver::lratExternal(const vec<Lit>& orig, const vec<Lit>& ps)
+{
+    uint64_t id = newId();
+    lrat_hints.clear();
+    outputLrat(id, orig, lrat_hints);
+    if (ps.size() != orig.size()){
+        lratUnits(orig, lrat_hints);
+        lrat_hints.push(id);
+        outputLrat(newId(), ps, lrat_hints);
+        outputLratDeleted(id);
+        id = next_id;
+    }
+    return id;
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  analyzeFinal : (p : Lit)  ->  [void]
@@ -504,8 +1148,10 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict)
                 assert(level(x) > 0);
                 out_conflict.insert(~trail[i]);
             }else{
-                Clause& c = ca[reasonLazy(x)];
-                for (int j = 1; j < c.size(); j++)
+                Lit        bin[2];
+                int        c_size;
+                const Lit* c = reasonLits(x, bin, c_size);
+                for (int j = 1; j < c_size; j++)
                     if (level(var(c[j])) > 0)
                         seen[var(c[j])] = 1;
             }
@@ -517,22 +1163,89 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict)
 }
 
 
-void Solver::uncheckedEnqueue(Lit p, CRef from)
+void Solver::uncheckedEnqueue(Lit p, CRef from, Lit other)
+{
+    assert(value(p) == l_Undef);
+    assigns[var(p)] = lbool(!sign(p));
+    vardata[var(p)] = mkVarData(from, decisionLevel(), other);
+    trail.push_(p);
+}
+
+
+void Solver::uncheckedEnqueue(Lit p, int level, CRef from, Lit other)
 {
     assert(value(p) == l_Undef);
+    assert(level <= decisionLevel());
     assigns[var(p)] = lbool(!sign(p));
-    vardata[var(p)] = mkVarData(from, decisionLevel());
+    vardata[var(p)] = mkVarData(from, level, other);
     trail.push_(p);
 }
 
 
+// Move the literal at position 'i' of a clause to the watched position 'k' (0 or 1), keeping the
+// watcher lists in sync.
+//
+void Solver::moveWatch(CRef cr, int i, int k)
+{
+    Clause& c = ca[cr];
+    if (i == k)
+        return;
+    else if (i < 2)
+        std::swap(c[0], c[1]);
+    else{
+        remove(watches[~c[k]], Watcher(cr, c[1-k]));
+        watches[~c[i]].push(Watcher(cr, c[1-k]));
+        std::swap(c[i], c[k]);
+    }
+}
+
+
+// The highest decision level of a literal in the conflicting clause 'confl'. With out-of-order
+// assignments it may be below the current level and it may have a single literal, in which case
+// the clause rather implies 'forced' on the next highest level. The literals of the two highest
+// levels are moved to the watched positions, so the clause is watched correctly after backtracking.
+//
+int Solver::conflictLevel(CRef confl, Lit& forced)
+{
+    forced = lit_Undef;
+    if (confl == CRef_Bin){
+        int l0 = level(var(bin_confl[0])), l1 = level(var(bin_confl[1]));
+        if (l0 != l1)
+            forced = l0 > l1 ? bin_confl[0] : bin_confl[1];
+        return l0 > l1 ? l0 : l1; }
+
+    Clause& c      = ca[confl];
+    int     max_i  = 0;
+    int     max_n  = 0;
+    int     max_lv = -1;
+    for (int i = 0; i < c.size(); i++){
+        int lv = level(var(c[i]));
+        if (lv > max_lv)
+            max_i = i, max_n = 1, max_lv = lv;
+        else if (lv == max_lv)
+            max_n++;
+    }
+
+    moveWatch(confl, max_i, 0);
+    int next_i = 1;
+    for (int i = 2; i < c.size(); i++)
+        if (level(var(c[i])) > level(var(c[next_i])))
+            next_i = i;
+    moveWatch(confl, next_i, 1);
+    if (max_n == 1)
+        forced = c[0];
+    return max_lv;
+}
+
+
 /*_________________________________________________________________________________________________
 |
 |  propagate : [void]  ->  [Clause*]
 |  
 |  Description:
 |    Propagates all enqueued facts. If a conflict arises, the conflicting clause is returned,
-|    otherwise CRef_Undef.
+|    otherwise CRef_Undef. Implicit binary clauses of a literal are propagated before its long
+|    clauses; a conflicting binary is returned as 'CRef_Bin' with its literals in 'bin_confl'.
 |  
 |    Post-conditions:
 |      * the propagation queue is empty, even if there was a conflict.
@@ -541,12 +1254,50 @@ CRef Solver::propagate()
 {
     CRef    confl     = CRef_Undef;
     int     num_props = 0;
+    int64_t num_ticks = 0;
 
     while (qhead < trail.size()){
+        if (ext_prop_active && ext_prop_pending >= ext_prop_int){
+            // Let the external propagator in before the fixpoint (see 'ext_prop_int'):
+            ext_prop_pending = 0;
+            notifyAssignments();
+            if (ext_num_watched == 0 || !ext_triggered.empty()){
+                if (ext_num_watched > 0){
+                    notifyWatched();
+                    ext_wake = true; }
+                if (propagateExternal(confl) == l_False){
+                    if (confl == CRef_Undef)
+                        ok = false;
+                    qhead = trail.size();
+                    break; }
+            }
+        }
+
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
+        int            lv  = level(var(p));      // (below the current level if 'p' was assigned out of order)
+        if (ext_prop_active && observed[var(p)])
+            ext_prop_pending++;
+        vec<BinWatcher>& bws = bin_watches[p];
+        num_props++;
+
+        // Binary clauses need no clause inspection:
+        for (BinWatcher *b = (BinWatcher*)bws, *bend = b + bws.size(); b != bend; b++){
+            Lit other = b->other;
+            if (value(other) == l_False){
+                confl        = CRef_Bin;
+                bin_confl[0] = ~p;
+                bin_confl[1] = other;
+                qhead        = trail.size();
+                break;
+            }else if (value(other) == l_Undef)
+                uncheckedEnqueue(other, lv, CRef_Bin, ~p);
+        }
+        if (confl != CRef_Undef)
+            break;
+
         vec<Watcher>&  ws  = watches.lookup(p);
         Watcher        *i, *j, *end;
-        num_props++;
+        num_ticks += 1 + ws.size();
 
         for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
             // Try to avoid inspecting the clause:
@@ -584,8 +1335,21 @@ CRef Solver::propagate()
                 // Copy the remaining watches:
                 while (i < end)
                     *j++ = *i++;
-            }else
+            }else if (lv == decisionLevel())
                 uncheckedEnqueue(first, cr);
+            else{
+                // Out of order: 'first' is implied on the highest level of the other literals, and
+                // the literal of that level must be watched:
+                int max_k = 1;
+                for (int k = 2; k < c.size(); k++)
+                    if (level(var(c[k])) > level(var(c[max_k])))
+                        max_k = k;
+                if (max_k != 1){
+                    c[1] = c[max_k]; c[max_k] = false_lit;
+                    j--;
+                    watches[~c[1]].push(w); }
+                uncheckedEnqueue(first, level(var(c[1])), cr);
+            }
 
         NextClause:;
         }
@@ -593,6 +1357,7 @@ CRef Solver::propagate()
     }
     propagations += num_props;
     simpDB_props -= num_props;
+    ticks        += num_ticks;
 
     return confl;
 }
@@ -603,26 +1368,36 @@ CRef Solver::propagate()
 |  reduceDB : ()  ->  [void]
 |  
 |  Description:
-|    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
-|    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    Remove half of the learnt clauses of the local tier, minus the clauses locked by the current
+|    assignment. Locked clauses are clauses that are reason to some assignment. Clauses in the core
+|    and tier-2 tiers are left alone, and binary clauses are never removed (while 'implicit_bins' is
+|    on, learnt binaries are kept in 'bin_watches' and do not even appear in 'learnts').
 |________________________________________________________________________________________________@*/
 struct reduceDB_lt { 
     ClauseAllocator& ca;
     reduceDB_lt(ClauseAllocator& ca_) : ca(ca_) {}
     bool operator () (CRef x, CRef y) { 
-        return ca[x].size() > 2 && (ca[y].size() == 2 || ca[x].activity() < ca[y].activity()); } 
+        Clause&       cx = ca[x];
+        Clause&       cy = ca[y];
+        bool          lx = cx.tier() == Solver::tier_local && cx.size() > 2;
+        bool          ly = cy.tier() == Solver::tier_local && cy.size() > 2;
+        return lx && (!ly || cx.activity() < cy.activity()); } 
 };
 void Solver::reduceDB()
 {
     int     i, j;
-    double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
+    int     n_local   = 0;
+    for (i = 0; i < learnts.size(); i++)
+        if (ca[learnts[i]].tier() == tier_local && ca[learnts[i]].size() > 2)
+            n_local++;
+    double  extra_lim = cla_inc / n_local;           // Remove any clause below this activity
 
     sort(learnts, reduceDB_lt(ca));
-    // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
-    // and clauses with activity smaller than 'extra_lim':
+    // Local clauses are sorted first. Don't delete locked clauses. From the rest, delete clauses
+    // from the first half and clauses with activity smaller than 'extra_lim':
     for (i = j = 0; i < learnts.size(); i++){
         Clause& c = ca[learnts[i]];
-        if (c.size() > 2 && !locked(c) && (i < learnts.size() / 2 || c.activity() < extra_lim))
+        if (i < n_local && !locked(c) && (i < n_local / 2 || c.activity() < extra_lim))
             removeClause(learnts[i]);
         else
             learnts[j++] = learnts[i];
@@ -632,6 +1407,55 @@ void Solver::reduceDB()
 }
 
 
+// Demote tier-2 clauses that took no part in conflict analysis since the last call to the local
+// tier, where they compete on activity with the rest:
+void Solver::reduceTier2()
+{
+    for (int i = 0; i < learnts.size(); i++){
+        Clause& c = ca[learnts[i]];
+        if (c.tier() != tier_two)
+            continue;
+        if (!c.used())
+            setTier(c, tier_local);
+        c.used(false);
+    }
+}
+
+
+// Add a learnt clause (e.g. one shared by another solver) at decision level 0. Returns FALSE if the
+// clause is empty under the current assignment. NOTE: nothing is written to the proof; the clause
+// must be there already (under the LRAT ID 'id'), unless there is no proof.
+bool Solver::addLearnt_(vec<Lit>& ps, int lbd, uint64_t id)
+{
+    assert(decisionLevel() == 0);
+    if (!ok) return false;
+
+    int i, j;
+    for (i = j = 0; i < ps.size(); i++)
+        if (value(ps[i]) == l_True)
+            return true;
+        else if (value(ps[i]) != l_False)
+            ps[j++] = ps[i];
+    ps.shrink(i - j);
+
+    if (ps.size() == 0)
+        return ok = false;
+    else if (ps.size() == 1)
+        uncheckedEnqueue(ps[0]);
+    else if (ps.size() == 2 && implicit_bins)
+        attachBinary(ps[0], ps[1], true);
+    else{
+        CRef   cr = ca.alloc(ps, true, id);
+        Clause& c = ca[cr];
+        c.lbd(lbd < ps.size() ? lbd : ps.size());
+        c.tier(lbdTier(lbd < ps.size() ? lbd : ps.size()));
+        learnts.push(cr);
+        attachClause(cr);
+    }
+    return true;
+}
+
+
 void Solver::removeSatisfied(vec<CRef>& cs)
 {
     int i, j;
@@ -655,7 +1479,15 @@ void Solver::removeSatisfied(vec<CRef>& cs)
 
             // proof output
             if (output) {
-                if (c.size() != oc.size()) {
+                if (c.size() != oc.size() && lrat) {
+                    uint64_t old = c.id();
+                    lrat_hints.clear();
+                    lratUnits(oc, lrat_hints);
+                    lrat_hints.push(old);
+                    c.id(newId());
+                    outputLrat(c.id(), c, lrat_hints);
+                    outputLratDeleted(old);
+                }else if (c.size() != oc.size()) {
                     outputPrintClause(c);
                     outputPrintClauseDeleted(oc);
                 }
@@ -668,6 +1500,83 @@ void Solver::removeSatisfied(vec<CRef>& cs)
 }
 
 
+void Solver::removeSatisfiedBins(bool originals)
+{
+    assert(decisionLevel() == 0);
+    for (int v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++){
+            // Every clause '(~p \/ other)' is stored twice, so only act on it from the list of its
+            // smallest literal:
+            Lit              p  = mkLit(v, s);
+            vec<BinWatcher>& ws = bin_watches[p];
+            int i, j;
+            for (i = j = 0; i < ws.size(); i++){
+                Lit other = ws[i].other;
+                if ((originals || ws[i].learnt) && (value(p) == l_False || value(other) == l_True)){
+                    if (~p < other){
+                        if (output)
+                            outputPrintClauseDeleted(~p, other);
+                        if (ws[i].learnt) num_learnts--, learnts_literals -= 2, num_tier[tier_core]--;
+                        else              num_clauses--, clauses_literals -= 2;
+                    }
+                }else
+                    ws[j++] = ws[i];
+            }
+            ws.shrink(i - j);
+        }
+}
+
+
+void Solver::vmtfEnqueue(Var x)
+{
+    VmtfLink& l = vmtf_links[x];
+    l.prev = vmtf_last;
+    l.next = var_Undef;
+    if (vmtf_last != var_Undef)
+        vmtf_links[vmtf_last].next = x;
+    else
+        vmtf_first = x;
+    vmtf_last     = x;
+    vmtf_stamp[x] = ++vmtf_time;
+}
+
+
+void Solver::vmtfBump(Var x)
+{
+    if (vmtf_last != x){
+        // Unlink:
+        VmtfLink& l = vmtf_links[x];
+        if (l.prev != var_Undef)
+            vmtf_links[l.prev].next = l.next;
+        else
+            vmtf_first = l.next;
+        vmtf_links[l.next].prev = l.prev;
+
+        vmtfEnqueue(x);
+    }else
+        vmtf_stamp[x] = ++vmtf_time;
+
+    if (value(x) == l_Undef && decision[x])
+        vmtf_unassigned = x;
+}
+
+
+// Only the active decision queue is maintained. Switching to VMTF keeps the queue as it is (its
+// order is updated by every bump anyway), switching back to VSIDS rebuilds 'order_heap':
+void Solver::selectDecisionQueue()
+{
+    bool use_vmtf = vmtf_mode == 2 || (vmtf_mode == 1 && !stable);
+    if (use_vmtf == vmtf_active)
+        return;
+
+    vmtf_active = use_vmtf;
+    if (vmtf_active)
+        vmtf_unassigned = vmtf_last;
+    else
+        rebuildOrderHeap();
+}
+
+
 void Solver::rebuildOrderHeap()
 {
     vec<Var> vs;
@@ -690,14 +1599,23 @@ bool Solver::simplify()
 {
     assert(decisionLevel() == 0);
 
-    if (!ok || propagate() != CRef_Undef)
-        return ok = false;
+    if (!ok) return false;
+    CRef confl = propagate();
+    if (confl != CRef_Undef){
+        if (output && lrat)
+            lratEmptyClause(confl);
+        return ok = false; }
 
     if (nAssigns() == simpDB_assigns || (simpDB_props > 0))
         return true;
 
+    // The reasons of the level 0 literals are removed below, so their unit clauses are needed now:
+    if (output && lrat)
+        lratUnitsDerived();
+
     // Remove satisfied clauses:
     removeSatisfied(learnts);
+    removeSatisfiedBins(remove_satisfied);
     if (remove_satisfied){       // Can be turned off.
         removeSatisfied(clauses);
 
@@ -715,7 +1633,8 @@ bool Solver::simplify()
                 trail[j++] = trail[i];
         trail.shrink(i - j);
         //printf("trail.size()= %d, qhead = %d\n", trail.size(), qhead);
-        qhead = trail.size();
+        qhead     = trail.size();
+        unit_head = 0;
 
         for (int i = 0; i < released_vars.size(); i++)
             seen[released_vars[i]] = 0;
@@ -741,6 +1660,7 @@ bool Solver::simplify()
 |  Description:
 |    Search for a model the specified number of conflicts. 
 |    NOTE! Use negative value for 'nof_conflicts' indicate infinity.
+|    With 'ema_restart' the search also stops when the moving averages of the LBD call for it.
 |  
 |  Output:
 |    'l_True' if a partial assigment that is consistent with respect to the clauseset is found. If
@@ -751,42 +1671,96 @@ lbool Solver::search(int nof_conflicts)
 {
     assert(ok);
     int         backtrack_level;
+    int         learnt_lbd;
     int         conflictC = 0;
     vec<Lit>    learnt_clause;
     starts++;
 
     for (;;){
     propagate:
+        ext_prop_active = ext_prop_int > 0 && external_propagator;
         CRef confl = propagate();
+        ext_prop_active = false;
+        if (!ok)
+            return l_False;
     analyze:
         if (confl != CRef_Undef){
             // CONFLICT
             conflicts++; conflictC++;
-            if (decisionLevel() == 0) return l_False;
+            int conflict_level = decisionLevel();
+            Lit forced         = lit_Undef;
+            if (chrono > 0 && conflict_level > 0)
+                conflict_level = conflictLevel(confl, forced);
+            if (conflict_level == 0){
+                if (output && lrat)
+                    lratEmptyClause(confl);
+                return l_False; }
+
+            if (forced != lit_Undef){
+                // The conflicting clause was missed as an implication on a lower level (literals on
+                // level 0 are always kept in order on the trail):
+                Lit other = confl == CRef_Bin ? bin_confl[bin_confl[0] == forced] : ca[confl][1];
+                int lv    = level(var(other));
+                cancelUntil(lv == 0 ? 0 : conflict_level - 1);
+                uncheckedEnqueue(forced, lv, confl, other);
+                continue; }
+            cancelUntil(conflict_level);
 
-            learnt_clause.clear();
-            analyze(confl, learnt_clause, backtrack_level);
-            cancelUntil(backtrack_level);
+            // Postpone the next restart while the trail is much longer than usual, since the
+            // solver might be close to a model:
+            trail_ema.update(trail.size());
+            if (stable_enabled)
+                updatePhases(trail_lim.last());
+            if (ema_restart && conflicts > restart_block_start && trail.size() > restart_block * trail_ema)
+                conflictC = 0;
 
+            learnt_clause.clear();
+            analyze(confl, learnt_clause, backtrack_level, learnt_lbd);
+            lbd_ema_fast.update(learnt_lbd);
+            lbd_ema_slow.update(learnt_lbd);
+            // Backtrack chronologically (one level) instead of far back, keeping the asserting
+            // literal as an out-of-order assignment. Units always go back to level 0:
+            if (chrono > 0 && backtrack_level > 0 && decisionLevel() - backtrack_level > chrono)
+                cancelUntil(decisionLevel() - 1);
+            else
+                cancelUntil(backtrack_level);
+
+            uint64_t id = lrat ? newId() : 0;
             if (learnt_clause.size() == 1){
                 assert(decisionLevel() == 0);
+                unit_id[var(learnt_clause[0])] = id;
                 uncheckedEnqueue(learnt_clause[0]);
+            }else if (learnt_clause.size() == 2 && implicit_bins){
+                attachBinary(learnt_clause[0], learnt_clause[1], true);
+                uncheckedEnqueue(learnt_clause[0], backtrack_level, CRef_Bin, learnt_clause[1]);
             }else{
-                CRef cr = ca.alloc(learnt_clause, true);
+                CRef   cr = ca.alloc(learnt_clause, true, id);
+                Clause& c = ca[cr];
+                c.lbd(learnt_lbd);
+                c.tier(lbdTier(learnt_lbd));
                 learnts.push(cr);
                 attachClause(cr);
                 claBumpActivity(ca[cr]);
-                uncheckedEnqueue(learnt_clause[0], cr);
+                uncheckedEnqueue(learnt_clause[0], backtrack_level, cr);
             }
 
             // proof print learned clause
             if (output) {
-                outputPrintClause(learnt_clause);
+                if (lrat)
+                    outputLrat(id, learnt_clause, lrat_hints);
+                else
+                    outputPrintClause(learnt_clause);
             }
+            if (share_learnts)
+                exportLearnt(learnt_clause, learnt_lbd);
 
             varDecayActivity();
             claDecayActivity();
 
+            if (conflicts >= next_tier2_reduce){
+                next_tier2_reduce = conflicts + tier2_interval;
+                reduceTier2(); }
+
             if (--learntsize_adjust_cnt == 0){
                 learntsize_adjust_confl *= learntsize_adjust_inc;
                 learntsize_adjust_cnt    = (int)learntsize_adjust_confl;
@@ -801,17 +1775,31 @@ lbool Solver::search(int nof_conflicts)
 
         }else{
             // NO CONFLICT
-            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()){
+            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || restartEMA(conflictC) || modeSwitchDue() || !withinBudget()){
                 // Reached bound on number of conflicts:
                 progress_estimate = progressEstimate();
+                if (stable_enabled){
+                    updatePhases(trail.size());
+                    target_assigned = 0; }
                 cancelUntil(0);
                 return l_Undef; }
 
+            if (stable_enabled && rephase_int > 0 && conflicts >= next_rephase)
+                rephase();
+
             // Simplify the set of problem clauses:
             if (decisionLevel() == 0 && !simplify())
                 return l_False;
 
-            if (learnts.size()-nAssigns() >= max_learnts)
+            // Add clauses learnt elsewhere, propagating any new units first:
+            if (decisionLevel() == 0){
+                if (!importLearnts())
+                    return l_False;
+                if (qhead < trail.size())
+                    continue;
+            }
+
+            if ((int)num_tier[tier_local]-nAssigns() >= max_learnts)
                 // Reduce the set of learnt clauses:
                 reduceDB();
 
@@ -833,49 +1821,44 @@ lbool Solver::search(int nof_conflicts)
 
             if (external_propagator) {
                 // notify backtrack and assignment
-                if (notify_backtrack) {
-                    external_propagator->notify_backtrack(decisionLevel());
-                    notify_backtrack = false;
-                }
-                if (notify_assignment_index < trail.size()) {
-                    std::vector<int> new_assignments; new_assignments.reserve(trail.size() - notify_assignment_index);
-                    while(notify_assignment_index < trail.size()) {
-                        new_assignments.push_back(LitToint(trail[notify_assignment_index++]));
-                    }
-                    external_propagator->notify_assignment(new_assignments);
-                }
+                notifyAssignments();
 
-                // request external units 
-                while (true) {
-                    int lit = external_propagator->cb_propagate();
-                    if (lit == 0) { break; }
-                    Lit l = intToLit(lit);
-                    if (value(l) != l_Undef) { continue; }
-                    // value(l) == l_False should cause conflict
-                    uncheckedEnqueue(l, sign(l) ? CRef_External_False : CRef_External_True);
-                    notify_assignment_index++; external_propagator->notify_assignment({lit});  // notify immediately to synchorize with external_propagator
-                    goto propagate;
-                }
+                // with watched literals, the propagator is idle until one of them is assigned
+                if (ext_num_watched == 0 || ext_wake || !ext_triggered.empty()) {
+                    ext_wake = true;
+                    if (ext_num_watched > 0)
+                        notifyWatched();
 
-                // request external clause
-                bool is_forgettable;
-                while (external_propagator->cb_has_external_clause(is_forgettable)) {
-                    add_tmp.clear();
-                    int lit;
-                    while (lit = external_propagator->cb_add_external_clause_lit()){
-                        add_tmp.push(intToLit(lit));
-                    }
-                    bool prop = false;
-                    bool unsat = add_clause_solving(add_tmp, is_forgettable, confl, prop);
-                    if (unsat) {
+                    // request external units
+                    lbool ext = propagateExternal(confl);
+                    if (ext == l_False && confl == CRef_Undef)
                         return l_False;
-                    }
-                    if (prop) {
-                        goto propagate;
-                    }
-                    if (confl != CRef_Undef) {
+                    else if (ext == l_False)
                         goto analyze;
+                    else if (ext == l_True)
+                        goto propagate;
+
+                    // request external clause
+                    bool is_forgettable;
+                    while (external_propagator->cb_has_external_clause(is_forgettable)) {
+                        size_t size;
+                        const int* lits = external_propagator->cb_add_external_clause(size);
+                        add_tmp.clear();
+                        for (size_t i = 0; i < size; i++)
+                            add_tmp.push(intToLit(lits[i]));
+                        bool prop = false;
+                        bool unsat = add_clause_solving(add_tmp, is_forgettable, confl, prop);
+                        if (unsat) {
+                            return l_False;
+                        }
+                        if (prop) {
+                            goto propagate;
+                        }
+                        if (confl != CRef_Undef) {
+                            goto analyze;
+                        }
                     }
+                    ext_wake = false;
                 }
             }
 
@@ -886,6 +1869,7 @@ lbool Solver::search(int nof_conflicts)
 
                 if (next == lit_Undef) {
                     if (external_propagator && !external_propagator->cb_check_found_model(getCurrentModel())) {
+                        ext_wake = true;
                         continue;
                     }
 
@@ -928,6 +1912,458 @@ double Solver::progressEstimate() const
 
  */
 
+/*_________________________________________________________________________________________________
+|
+|  Search modes:
+|  
+|    With 'stable_enabled' the search alternates between the focused mode (the restart policy
+|    configured above) and a stable mode with Luby restarts based on 'stable_restart_first' in which
+|    decisions follow the target phases. The first focused mode lasts 'mode_init' conflicts, the
+|    length of each following pair of modes is doubled. With 'mode_ticks' the later modes are
+|    measured in propagation ticks, taking the ticks spent in the first mode as the unit.
+|________________________________________________________________________________________________@*/
+bool Solver::modeSwitchDue() const
+{
+    if (!stable_enabled)
+        return false;
+    else if (mode_switches == 0)
+        return conflicts - mode_start_conflicts >= (uint64_t)mode_init;
+
+    uint64_t length  = mode_unit << (mode_switches / 2 < 32 ? mode_switches / 2 : 32);
+    uint64_t elapsed = mode_ticks ? ticks - mode_start_ticks : conflicts - mode_start_conflicts;
+    return elapsed >= length;
+}
+
+
+void Solver::switchMode()
+{
+    if (mode_switches == 0)
+        mode_unit = mode_ticks ? ticks - mode_start_ticks + 1 : mode_init;
+    mode_switches++;
+    mode_start_conflicts = conflicts;
+    mode_start_ticks     = ticks;
+    stable               = !stable;
+    target_assigned      = 0;
+}
+
+
+// Called with a conflict-free prefix of the trail. Longer prefixes replace the target and best phases:
+void Solver::updatePhases(int assigned)
+{
+    if (assigned > target_assigned){
+        for (int i = 0; i < assigned; i++)
+            target[var(trail[i])] = lbool(!sign(trail[i]));
+        target_assigned = assigned; }
+
+    if (assigned > best_assigned){
+        for (int i = 0; i < assigned; i++)
+            best[var(trail[i])] = lbool(!sign(trail[i]));
+        best_assigned = assigned; }
+}
+
+
+// Overwrite the saved phases, cycling through original (MiniSat's default negative phase), best,
+// inverted, best, random, best. The target phases start over from the new ones.
+void Solver::rephase()
+{
+    static const char schedule[] = "OBIBRB";
+    char kind = schedule[rephases % (sizeof(schedule) - 1)];
+
+    for (Var v = 0; v < nVars(); v++){
+        switch (kind){
+        case 'O': polarity[v] = true; break;
+        case 'I': polarity[v] = false; break;
+        case 'R': polarity[v] = drand(random_seed) < 0.5; break;
+        case 'B': if (best[v] != l_Undef) polarity[v] = best[v] == l_False; break;
+        }
+        target[v] = lbool(!polarity[v]);
+    }
+    if (kind == 'B')
+        best_assigned = 0;
+    target_assigned = 0;
+
+    rephases++;
+    next_rephase = conflicts + (uint64_t)rephase_int * (rephases + 1);
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  Inprocessing:
+|  
+|    With 'inprocess_int' > 0, 'inprocess()' is run at a restart every 'inprocess_int' * k conflicts
+|    in round k. With 'inprocess_ticks', the intervals after the first are measured in propagation
+|    ticks instead, taking the ticks per conflict of the first interval as the exchange rate. A
+|    round is skipped if the time spent on inprocessing would exceed 'inprocess_frac' of the time
+|    spent in 'solve_()'.
+|________________________________________________________________________________________________@*/
+bool Solver::inprocessDue() const
+{
+    return inprocess_int > 0 && (inprocess_unit > 0 ? ticks : conflicts) >= next_inprocess;
+}
+
+
+bool Solver::inprocessRound(double solve_start)
+{
+    assert(decisionLevel() == 0);
+    double start  = cpuTime();
+    bool   result = true;
+    if (inprocess_time <= inprocess_frac * (search_time + start - solve_start)){
+        result = inprocess();
+        inprocessings++;
+        inprocess_time += cpuTime() - start; }
+
+    if (inprocess_ticks && inprocess_unit == 0 && conflicts > 0)
+        inprocess_unit = ticks / conflicts * inprocess_int + 1;
+    inprocess_rounds++;
+    next_inprocess = inprocess_unit > 0 ? ticks + inprocess_unit * (inprocess_rounds + 1)
+                                        : conflicts + (uint64_t)inprocess_int * (inprocess_rounds + 1);
+    return result;
+}
+
+
+// The solver itself probes literals, vivifies clauses and removes the clauses satisfied at level 0.
+// Subclasses extend this with techniques that need occurrence lists (see 'SimpSolver::inprocess()').
+bool Solver::inprocess()
+{
+    if (!probe() || !vivify(true))
+        return false;
+    simpDB_props = 0;
+    return simplify();
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  probe : ()  ->  [bool]
+|  
+|  Description:
+|    Failed literal probing. The roots of the binary implication graph (literals that imply others
+|    through binary clauses, but are not implied by any) are propagated at a probe level, and so
+|    are both literals of a variable if both imply others. This goes on from where the last round
+|    stopped until the effort limit 'probe_effort' is used up. Returns FALSE if the problem was
+|    found to be unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool Solver::probe()
+{
+    assert(decisionLevel() == 0);
+    if (!probe_enabled || nVars() == 0 || !simplify())
+        return ok;
+
+    // Count the binary clauses of each literal, implicit or in the arena:
+    bin_count.reserve(mkLit(nVars() - 1, true), 0);
+    for (int i = 0; i < 2 * nVars(); i++){
+        const vec<BinWatcher>& ws = bin_watches[toLit(i)];
+        for (int j = 0; j < ws.size(); j++)
+            bin_count[ws[j].other]++;
+    }
+    for (int pass = 0; pass < 2; pass++){
+        const vec<CRef>& cs = pass == 0 ? clauses : learnts;
+        for (int i = 0; i < cs.size(); i++){
+            const Clause& c = ca[cs[i]];
+            if (c.size() == 2 && c.mark() != 1)
+                bin_count[c[0]]++, bin_count[c[1]]++;
+        }
+    }
+
+    uint64_t start      = ticks;
+    uint64_t limit      = (uint64_t)((ticks - probe_ticks) * probe_effort);
+    int      hbr_budget = probe_hbr_lim;
+    if (probe_next >= 2 * nVars())
+        probe_next = 0;
+
+    for (int n = 0; n < 2 * nVars() && ticks - start <= limit; n++){
+        Lit p = toLit(probe_next);
+        probe_next = probe_next + 1 < 2 * nVars() ? probe_next + 1 : 0;
+        if (value(p) == l_Undef && decision[var(p)] && bin_count[~p] > 0 && (bin_count[p] == 0 || !sign(p)) && !probeLit(p, hbr_budget))
+            break;
+    }
+
+    for (int i = 0; i < 2 * nVars(); i++)
+        bin_count[toLit(i)] = 0;
+    probe_ticks = ticks;
+    return ok;
+}
+
+
+// Propagates 'p' and, unless it is a root ('~p' would imply nothing), then '~p'. A conflict makes
+// the negation of the probe a unit, and so are the literals implied by both probes (necessary
+// assignments). A literal 'q' implied by 'p' through a longer clause with at least two of its other
+// literals assigned by the probe gets the hyper-binary resolvent '(q \/ ~p)' as a learnt binary,
+// which makes later propagations of 'p' cheaper.
+//
+bool Solver::probeLit(Lit p, int& hbr_budget)
+{
+    probes++;
+    newProbeLevel();
+    uncheckedEnqueue(p);
+    CRef confl = propagate();
+    if (confl != CRef_Undef)
+        return probeUnit(p, confl);
+
+    // Hyper-binary resolvents (written to the proof before the probe is undone):
+    probe_hbr.clear();
+    probe_ids.clear();
+    probe_implied.clear();
+    probe_mark.reserve(mkLit(nVars() - 1, true), 0);
+    for (int i = trail_lim[0] + 1; i < trail.size(); i++){
+        Lit  q = trail[i];
+        CRef r = reason(var(q));
+        probe_implied.push(q);
+        probe_mark[q] = 1;
+        if (hbr_budget == 0 || r == CRef_Bin || ca[r].size() < 3)
+            continue;
+
+        int assigned = 0;
+        for (int k = 1; k < ca[r].size() && assigned < 2; k++)
+            assigned += level(var(ca[r][k])) > 0;
+        if (assigned < 2)
+            continue;
+
+        probe_lits.clear();
+        probe_lits.push(q);
+        probe_lits.push(~p);
+        probe_hints.clear();
+        if (output != NULL && lrat)
+            lratChain(r, probe_lits, probe_hints);
+        probe_hbr.push(q);
+        probe_ids.push(proofLemma(probe_lits, probe_hints));
+        hbr_budget--;
+    }
+    cancelProbe();
+
+    for (int i = 0; i < probe_hbr.size(); i++){
+        probe_lits.clear();
+        probe_lits.push(probe_hbr[i]);
+        probe_lits.push(~p);
+        addLearnt_(probe_lits, 2, probe_ids[i]);
+        hyper_bins++;
+    }
+
+    if (bin_count[p] == 0){
+        for (int i = 0; i < probe_implied.size(); i++)
+            probe_mark[probe_implied[i]] = 0;
+        return true; }
+
+    // The opposite polarity; common implications are collected in 'probe_lits':
+    newProbeLevel();
+    uncheckedEnqueue(~p);
+    confl = propagate();
+    probe_lits.clear();
+    if (confl == CRef_Undef)
+        for (int i = trail_lim[0] + 1; i < trail.size(); i++)
+            if (probe_mark[trail[i]])
+                probe_lits.push(trail[i]);
+    for (int i = 0; i < probe_implied.size(); i++)
+        probe_mark[probe_implied[i]] = 0;
+    if (confl != CRef_Undef)
+        return probeUnit(~p, confl);
+    else if (probe_lits.size() == 0){
+        cancelProbe();
+        return true; }
+
+    // Every necessary assignment 'q' follows from the lemmas '(q \/ p)' and '(q \/ ~p)', which are
+    // derived from the probe '~p' and from propagating 'p' once more:
+    vec<Lit>& units = probe_implied;
+    probe_lits.copyTo(units);
+    probe_ids.clear();
+    for (int pass = 0; pass < 2; pass++){
+        if (pass == 1){
+            newProbeLevel();
+            uncheckedEnqueue(p);
+            confl = propagate();
+            assert(confl == CRef_Undef); }
+        for (int i = 0; i < units.size(); i++){
+            assert(value(units[i]) == l_True && level(var(units[i])) > 0);
+            probe_lits.clear();
+            probe_lits.push(units[i]);
+            probe_lits.push(pass == 0 ? p : ~p);
+            probe_hints.clear();
+            if (output != NULL && lrat)
+                lratChain(reason(var(units[i])), probe_lits, probe_hints);
+            probe_ids.push(proofLemma(probe_lits, probe_hints));
+        }
+        cancelProbe();
+    }
+
+    for (int i = 0; i < units.size(); i++){
+        Lit q = units[i];
+        if (ok && value(q) == l_Undef){
+            probe_lits.clear();
+            probe_lits.push(q);
+            probe_hints.clear();
+            if (output != NULL && lrat){
+                probe_hints.push(probe_ids[units.size() + i]);
+                probe_hints.push(probe_ids[i]); }
+            failed_lits++;
+            addClause_(probe_lits, proofLemma(probe_lits, probe_hints));
+        }
+        if (output != NULL && lrat){
+            outputLratDeleted(probe_ids[i]);
+            outputLratDeleted(probe_ids[units.size() + i]);
+        }else if (output != NULL){
+            outputPrintClauseDeleted(q, p);
+            outputPrintClauseDeleted(q, ~p); }
+    }
+    return ok;
+}
+
+
+bool Solver::probeUnit(Lit p, CRef confl)
+{
+    probe_lits.clear();
+    probe_lits.push(~p);
+    probe_hints.clear();
+    if (output != NULL && lrat)
+        lratChain(confl, probe_lits, probe_hints);
+    cancelProbe();
+    failed_lits++;
+    return addClause_(probe_lits, proofLemma(probe_lits, probe_hints));
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  vivify : (irredundant : bool)  ->  [bool]
+|  
+|  Description:
+|    Clause vivification. The literals of a clause (detached for the time being) are falsified one
+|    at a time at a probe level, until propagation runs into a conflict or implies another literal
+|    of the clause. The literals falsified so far, and the implied one, form a clause that follows
+|    by unit propagation and replaces the original one; literals found false on the way are dropped.
+|    A learnt clause whose last literal is implied is removed altogether. The learnt clauses of the
+|    core and tier-2 tiers are tried first, by LBD and then activity, and with 'irredundant' the
+|    problem clauses follow under a separate budget ('vivify_irred_effort'). Each clause is tried
+|    once. Returns FALSE if the problem was found to be unsatisfiable.
+|________________________________________________________________________________________________@*/
+struct vivify_lt {
+    ClauseAllocator& ca;
+    vivify_lt(ClauseAllocator& ca_) : ca(ca_) {}
+    bool operator () (CRef x, CRef y) {
+        Clause& cx = ca[x];
+        Clause& cy = ca[y];
+        return cx.lbd() < cy.lbd() || (cx.lbd() == cy.lbd() && cx.activity() > cy.activity()); }
+};
+bool Solver::vivify(bool irredundant)
+{
+    assert(decisionLevel() == 0);
+    if (!vivify_enabled || !simplify())
+        return ok;
+
+    uint64_t search = ticks - vivify_ticks;
+    for (int pass = 0; pass < 1 + irredundant && ok; pass++){
+        vec<CRef>& cs    = pass == 0 ? learnts : clauses;
+        uint64_t   start = ticks;
+        uint64_t   limit = (uint64_t)(search * (pass == 0 ? vivify_effort : vivify_irred_effort));
+
+        vivify_cands.clear();
+        for (int i = 0; i < cs.size(); i++){
+            const Clause& c = ca[cs[i]];
+            if (c.mark() != 1 && c.size() > 2 && !c.vivified() && (pass == 0 ? c.tier() != tier_local : !c.learnt()))
+                vivify_cands.push(cs[i]);
+        }
+        if (pass == 0)
+            sort(vivify_cands, vivify_lt(ca));
+
+        vivify_added.clear();
+        for (int i = 0; i < vivify_cands.size() && ticks - start <= limit && !asynch_interrupt; i++)
+            if (!vivifyClause(vivify_cands[i]))
+                break;
+
+        // The shortened clauses take the place of the removed ones:
+        int i, j;
+        for (i = j = 0; i < cs.size(); i++)
+            if (!isRemoved(cs[i]))
+                cs[j++] = cs[i];
+        cs.shrink(i - j);
+        append(vivify_added, cs);
+    }
+
+    vivify_ticks = ticks;
+    checkGarbage();
+    return ok;
+}
+
+
+// Vivifies the clause 'cr' (see 'vivify()'). The shortened clause goes to 'vivify_added', unless it
+// is a unit or an implicit binary.
+bool Solver::vivifyClause(CRef cr)
+{
+    Clause& c = ca[cr];
+    c.vivified(true);
+    for (int i = 0; i < c.size(); i++)
+        if (value(c[i]) == l_True)
+            return true;        // (satisfied at level 0, left to 'simplify()')
+
+    detachClause(cr, true);
+    newProbeLevel();
+    vivify_lits.clear();
+    CRef confl   = cr;          // (the clause falsified by the negation of 'vivify_lits')
+    bool implied = false;
+    for (int i = 0; i < c.size(); i++){
+        Lit l = c[i];
+        if (value(l) == l_False)
+            continue;
+        vivify_lits.push(l);
+        if (value(l) == l_True){
+            confl   = reason(var(l));
+            implied = true;
+            break; }
+
+        uncheckedEnqueue(~l);
+        CRef r = propagate();
+        if (r != CRef_Undef){
+            confl = r;
+            break; }
+    }
+
+    int removed = c.size() - vivify_lits.size();
+    if (removed == 0 && !(implied && c.learnt())){
+        cancelProbe();
+        attachClause(cr);
+        return true; }
+
+    // The shortened clause is written to the proof while the probe is still there to justify it:
+    uint64_t id = 0;
+    if (removed > 0){
+        probe_hints.clear();
+        if (output != NULL && lrat)
+            lratChain(confl, vivify_lits, probe_hints);
+        id = proofLemma(vivify_lits, probe_hints);
+    }
+    cancelProbe();
+
+    bool     learnt = c.learnt();
+    unsigned lbd    = learnt ? c.lbd() : 0;
+    unsigned tier   = learnt ? c.tier() : 0;
+    float    act    = learnt ? c.activity() : 0;
+    proofDeleted(c);
+    c.mark(1);
+    ca.free(cr);
+    vivified++;
+    vivified_lits += removed;
+
+    if (removed == 0)
+        return true;
+    else if (vivify_lits.size() == 1)
+        return addClause_(vivify_lits, id);
+    else if (vivify_lits.size() == 2 && implicit_bins)
+        attachBinary(vivify_lits[0], vivify_lits[1], learnt);
+    else{
+        CRef    nr = ca.alloc(vivify_lits, learnt, id);
+        Clause& d  = ca[nr];
+        d.vivified(true);
+        if (learnt){
+            d.lbd(lbd < (unsigned)d.size() ? lbd : d.size());
+            d.tier(tier);
+            d.activity(act); }
+        attachClause(nr);
+        vivify_added.push(nr);
+    }
+    return true;
+}
+
+
 static double luby(double y, int x){
 
     // Find the finite subsequence that contains index 'x', and the
@@ -959,6 +2395,11 @@ lbool Solver::solve_()
 
     learntsize_adjust_confl   = learntsize_adjust_start_confl;
     learntsize_adjust_cnt     = (int)learntsize_adjust_confl;
+    next_tier2_reduce         = conflicts + tier2_interval;
+    next_rephase              = conflicts + (uint64_t)rephase_int * (rephases + 1);
+    next_inprocess            = inprocess_unit > 0 ? ticks + inprocess_unit * (inprocess_rounds + 1)
+                                                   : conflicts + (uint64_t)inprocess_int * (inprocess_rounds + 1);
+    double  solve_start       = cpuTime();
     lbool   status            = l_Undef;
 
     if (verbosity >= 1){
@@ -971,10 +2412,21 @@ lbool Solver::solve_()
     // Search:
     int curr_restarts = 0;
     while (status == l_Undef){
-        double rest_base = luby_restart ? luby(restart_inc, curr_restarts) : pow(restart_inc, curr_restarts);
-        status = search(rest_base * restart_first);
+        if (modeSwitchDue())
+            switchMode();
+        selectDecisionQueue();
+
+        if (stable)
+            status = search(luby(2, stable_restarts++) * stable_restart_first);
+        else{
+            double rest_base = luby_restart ? luby(restart_inc, curr_restarts) : pow(restart_inc, curr_restarts);
+            status = search(ema_restart ? -1 : rest_base * restart_first);
+            curr_restarts++;
+        }
         if (!withinBudget()) break;
-        curr_restarts++;
+
+        if (status == l_Undef && inprocessDue() && !inprocessRound(solve_start))
+            status = l_False;
     }
 
     if (verbosity >= 1)
@@ -989,6 +2441,8 @@ lbool Solver::solve_()
         ok = false;
 
     cancelUntil(0);
+    outputFlush();
+    search_time += cpuTime() - solve_start;
     return status;
 }
 
@@ -1052,6 +2506,22 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
                     mapVar(var(c[j]), map, max);
         }
 
+    // Implicit binary clauses '(~p \/ other)', each visited once from its smallest literal:
+    vec<Lit> bins;
+    for (int v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++){
+            Lit p = mkLit(v, s);
+            const vec<BinWatcher>& ws = bin_watches[p];
+            for (int j = 0; j < ws.size(); j++)
+                if (!ws[j].learnt && ~p < ws[j].other && value(~p) != l_True && value(ws[j].other) != l_True){
+                    bins.push(~p);
+                    bins.push(ws[j].other);
+                    mapVar(var(~p), map, max);
+                    mapVar(var(ws[j].other), map, max);
+                    cnt++;
+                }
+        }
+
     // Assumptions are added as unit clauses:
     cnt += assumps.size();
 
@@ -1065,6 +2535,10 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
     for (int i = 0; i < clauses.size(); i++)
         toDimacs(f, ca[clauses[i]], map, max);
 
+    for (int i = 0; i < bins.size(); i += 2)
+        fprintf(f, "%s%d %s%d 0\n", sign(bins[i])   ? "-" : "", mapVar(var(bins[i]),   map, max)+1,
+                                     sign(bins[i+1]) ? "-" : "", mapVar(var(bins[i+1]), map, max)+1);
+
     if (verbosity > 0)
         printf("Wrote DIMACS with %d variables and %d clauses.\n", max, cnt);
 }
@@ -1076,9 +2550,18 @@ void Solver::printStats() const
     double mem_used = memUsedPeak();
     printf("restarts              : %"PRIu64"\n", starts);
     printf("conflicts             : %-12"PRIu64"   (%.0f /sec)\n", conflicts   , conflicts   /cpu_time);
+    if (stable_enabled)
+        printf("mode switches         : %-12"PRIu64"   (%"PRIu64" rephases)\n", mode_switches, rephases);
+    if (inprocess_int > 0)
+        printf("inprocessing rounds   : %-12"PRIu64"   (%.2f s)\n", inprocessings, inprocess_time);
+    if (inprocess_int > 0 && probe_enabled)
+        printf("probes                : %-12"PRIu64"   (%"PRIu64" units, %"PRIu64" hyper-binary resolvents)\n", probes, failed_lits, hyper_bins);
+    if (inprocess_int > 0 && vivify_enabled)
+        printf("vivified clauses      : %-12"PRIu64"   (%"PRIu64" literals removed)\n", vivified, vivified_lits);
     printf("decisions             : %-12"PRIu64"   (%4.2f %% random) (%.0f /sec)\n", decisions, (float)rnd_decisions*100 / (float)decisions, decisions   /cpu_time);
     printf("propagations          : %-12"PRIu64"   (%.0f /sec)\n", propagations, propagations/cpu_time);
     printf("conflict literals     : %-12"PRIu64"   (%4.2f %% deleted)\n", tot_literals, (max_literals - tot_literals)*100 / (double)max_literals);
+    printf("learnt clauses        : %-12"PRIu64"   (core %"PRIu64", tier2 %"PRIu64", local %"PRIu64")\n", num_learnts, num_tier[tier_core], num_tier[tier_two], num_tier[tier_local]);
     if (mem_used != 0) printf("Memory used           : %.2f MB\n", mem_used);
     printf("CPU time              : %g s\n", cpu_time);
 }
@@ -1107,7 +2590,7 @@ void Solver::relocAll(ClauseAllocator& to)
 
         // Note: it is not safe to call 'locked()' on a relocated clause. This is why we keep
         // 'dangling' reasons here. It is safe and does not hurt.
-        if (reason(v) != CRef_Undef && !isReasonLazy(v) && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
+        if (reason(v) != CRef_Undef && reason(v) != CRef_Bin && !isReasonLazy(v) && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
             assert(!isRemoved(reason(v)));
             ca.reloc(vardata[v].reason, to);
         }
@@ -1140,6 +2623,7 @@ void Solver::garbageCollect()
     // is not precise but should avoid some unnecessary reallocations for the new region:
     ClauseAllocator to(ca.size() - ca.wasted()); 
 
+    to.clause_ids = ca.clause_ids;
     relocAll(to);
     if (verbosity >= 2)
         printf("|  Garbage collection:   %12d bytes => %12d bytes             |\n", 
@@ -1175,6 +2659,7 @@ void Solver::sort_clause_solving(vec<Lit>& ps) {
 bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict, bool& propagate) {
     // empty clause
     if (ps.size() == 0) {
+        if (output && lrat) lratExternal(ps, ps);
         return true;
     }
 
@@ -1214,6 +2699,7 @@ bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict,
 
     // empty
     if (ps.size() == 0) {
+        if (output && lrat) lratExternal(oc, ps);
         return true;
     }
 
@@ -1223,8 +2709,11 @@ bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict,
     }
 
     // proof output
+    uint64_t id = 0;
     if (output) {
-        if (ps.size() != oc.size()) {
+        if (lrat) {
+            id = lratExternal(oc, ps);
+        } else if (ps.size() != oc.size()) {
             outputPrintClause(ps);
             outputPrintClauseDeleted(oc);
         }
@@ -1233,14 +2722,20 @@ bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict,
     // unit
     if (ps.size() == 1) {
         cancelUntil(0);
+        unit_id[var(ps[0])] = id;
         uncheckedEnqueue(ps[0]);
         propagate = true;
         return false;
     }
 
-    CRef cr = ca.alloc(ps, forgettable);
-    clauses.push(cr);
-    attachClause(cr);
+    CRef cr = CRef_Bin;
+    if (ps.size() == 2 && implicit_bins) {
+        attachBinary(ps[0], ps[1], forgettable);
+    } else {
+        cr = ca.alloc(ps, forgettable, id);
+        clauses.push(cr);
+        attachClause(cr);
+    }
 
     Lit a = ps[0], b = ps[1];
     if (value(a) == l_False) {
@@ -1249,18 +2744,22 @@ bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict,
             assert(a < b);
             cancelUntil(level(a));
             conflict = cr;
+            bin_confl[0] = a; bin_confl[1] = b;
             return false;
         } else {
             assert(level(a) > level(b));
-            cancelUntil(level(b));
-            uncheckedEnqueue(a, cr);
+            int lv = level(b);
+            cancelUntil(chrono > 0 && lv > 0 ? level(a) - 1 : lv);
+            uncheckedEnqueue(a, lv, cr, b);
             propagate = true;
             return false;
         }
     } else if (value(a) == l_Undef) {
         if (value(b) == l_False) {
-            cancelUntil(level(b));
-            uncheckedEnqueue(a, cr);
+            int lv = level(b);
+            if (chrono == 0 || lv == 0)
+                cancelUntil(lv);
+            uncheckedEnqueue(a, lv, cr, b);
             propagate = true;
             return false;
         } else {
@@ -1271,8 +2770,9 @@ bool Solver::add_clause_solving(vec<Lit>& ps, bool forgettable, CRef& conflict,
         assert(value(a) == l_True);
         if (value(b) == l_False) {
             if (level(a) > level(b)) {
-                cancelUntil(level(b));
-                uncheckedEnqueue(a, cr);
+                int lv = level(b);
+                cancelUntil(chrono > 0 && lv > 0 ? level(a) - 1 : lv);
+                uncheckedEnqueue(a, lv, cr, b);
                 propagate = true;
                 return false;
             }
@@ -1331,8 +2831,11 @@ CRef Solver::add_clause_lazy(Lit unit, vec<Lit>& ps) {
     }
 
     // proof output
+    uint64_t id = 0;
     if (output) {
-        if (ps.size() != oc.size()) {
+        if (lrat) {
+            id = lratExternal(oc, ps);
+        } else if (ps.size() != oc.size()) {
             outputPrintClause(ps);
             outputPrintClauseDeleted(oc);
         }
@@ -1353,32 +2856,187 @@ CRef Solver::add_clause_lazy(Lit unit, vec<Lit>& ps) {
     assert(value(b) == l_False);
     assert(level(a) >= level(b));  // level(a) > level(b) is possible
 
-    CRef cr = ca.alloc(ps, true);  // lazily added clauses are always forgettable
+    if (ps.size() == 2 && implicit_bins) {
+        attachBinary(a, b, true);
+        vardata[var(a)].other = b;
+        return CRef_Bin;
+    }
+
+    CRef cr = ca.alloc(ps, true, id);  // lazily added clauses are always forgettable
     clauses.push(cr);
     attachClause(cr);
 
     return cr;
 }
 
+// Notify the external propagator of a backtrack and the (observed) assignments since the last
+// notification.
+void Solver::notifyAssignments() {
+    if (notify_backtrack) {
+        external_propagator->notify_backtrack(decisionLevel());
+        notify_backtrack = false;
+    }
+    if (notify_assignment_index < trail.size()) {
+        size_t notified = notify_trail.size();
+        while(notify_assignment_index < trail.size()) {
+            while (notify_lim.size() < (size_t)trail_lim.size() && trail_lim[notify_lim.size()] <= notify_assignment_index)
+                notify_lim.push_back(notify_trail.size());
+            Lit l = trail[notify_assignment_index++];
+            if (observed[var(l)]) {
+                notify_trail.push_back(LitToint(l));
+                if (ext_watched[l])
+                    ext_triggered.push_back(notify_trail.back());
+            }
+        }
+        if (notify_trail.size() > notified)
+            external_propagator->notify_assignment(notify_trail.data() + notified, notify_trail.size() - notified);
+    }
+}
+
+// Pass the watched literals assigned since the last call of the external propagator (and still true).
+void Solver::notifyWatched() {
+    size_t j = 0;
+    for (size_t i = 0; i < ext_triggered.size(); i++)
+        if (value(intToLit(ext_triggered[i])) == l_True)
+            ext_triggered[j++] = ext_triggered[i];
+    if (j > 0)
+        external_propagator->notify_watched(ext_triggered.data(), j);
+    ext_triggered.clear();
+}
+
+// Assign the literals propagated by the external propagator, all at once. Their reasons are either
+// asked for when needed (see 'reasonLazy()') or given right away, and then added like the lazy ones
+// (at level 0 as unit clauses). The new assignments are notified immediately to stay in sync with
+// the external propagator. A literal that is false already is a conflict: its reason is learnt like
+// an external clause after that. Returns l_True if anything was assigned (the propagator is asked
+// again as long as it only returns true literals), l_False on a conflict (in 'confl', or CRef_Undef
+// if the problem is unsatisfiable) and l_Undef otherwise.
+lbool Solver::propagateExternal(CRef& confl) {
+    int        assigned        = trail.size();
+    int        conflict_lit    = 0;
+    const int* conflict_reason = nullptr;
+    while (trail.size() == assigned && conflict_lit == 0) {
+        size_t size;
+        const int* reasons;
+        const int* lits = external_propagator->cb_propagate_lits(size, reasons);
+        if (size == 0)
+            return l_Undef;
+
+        for (size_t i = 0; i < size; i++) {
+            Lit l = intToLit(lits[i]);
+            const int* reason = reasons;
+            if (reasons) {
+                add_tmp.clear();
+                while (*reasons)
+                    add_tmp.push(intToLit(*reasons++));
+                reasons++;
+            }
+            if (value(l) == l_False && conflict_lit == 0) {
+                conflict_lit    = lits[i];
+                conflict_reason = reason;
+            }
+            if (value(l) != l_Undef)
+                continue;
+            if (reasons && decisionLevel() == 0) {
+                CRef unit_confl = CRef_Undef;
+                bool prop = false;
+                bool unsat = add_clause_solving(add_tmp, external_propagator->are_reasons_forgettable, unit_confl, prop);
+                assert(!unsat && unit_confl == CRef_Undef && value(l) == l_True);
+                (void)unsat;
+            } else {
+                uncheckedEnqueue(l, sign(l) ? CRef_External_False : CRef_External_True);
+                if (reasons)
+                    vardata[var(l)].reason = add_clause_lazy(l, add_tmp);
+            }
+        }
+    }
+    notifyAssignments();
+
+    if (conflict_lit != 0) {
+        add_tmp.clear();
+        if (conflict_reason) {
+            while (*conflict_reason)
+                add_tmp.push(intToLit(*conflict_reason++));
+        } else {
+            size_t size;
+            const int* lits = external_propagator->cb_add_reason_clause(conflict_lit, size);
+            for (size_t i = 0; i < size; i++)
+                add_tmp.push(intToLit(lits[i]));
+        }
+        bool prop = false;
+        confl = CRef_Undef;
+        if (add_clause_solving(add_tmp, external_propagator->are_reasons_forgettable, confl, prop) || confl != CRef_Undef)
+            return l_False;
+        else if (prop)
+            return l_True;
+    }
+    return trail.size() > assigned ? l_True : l_Undef;
+}
+
 void Solver::connect_external_propagator (ExternalPropagator *external_propagator) {
     this->external_propagator = external_propagator;
     notify_assignment_index = 0;
     notify_backtrack = false;
+    notify_trail.clear();
+    notify_lim.clear();
 
     // notify existing assignments and levels?
 }
 
 void Solver::disconnect_external_propagator () {
+    reset_watched_lits();
+    reset_observed_vars();
     this->external_propagator = nullptr;
 }
 
+void Solver::setObserved (Var v, bool b) {
+    observed[v] = (char)b;
+}
+
 void Solver::add_observed_var (int idx) {
+    assert(external_propagator);
+    Var v = abs(idx) - 1;
+    assert(v < nVars());
+    if (!observed[v])
+        setObserved(v, true);
 }
 
 void Solver::remove_observed_var (int idx) {
+    Var v = abs(idx) - 1;
+    assert(v < nVars());
+    if (observed[v])
+        setObserved(v, false);
 }
 
 void Solver::reset_observed_vars () {
+    for (Var v = 0; v < nVars(); v++)
+        if (observed[v])
+            setObserved(v, false);
+}
+
+void Solver::add_watched_lit (int lit) {
+    Lit l = intToLit(lit);
+    assert(var(l) < nVars() && observed[var(l)]);
+    if (!ext_watched[l]) {
+        ext_watched[l] = 1;
+        ext_num_watched++;
+    }
+}
+
+void Solver::remove_watched_lit (int lit) {
+    Lit l = intToLit(lit);
+    assert(var(l) < nVars());
+    if (ext_watched[l]) {
+        ext_watched[l] = 0;
+        ext_num_watched--;
+    }
+}
+
+void Solver::reset_watched_lits () {
+    for (Var v = 0; v < nVars(); v++)
+        ext_watched[mkLit(v, false)] = ext_watched[mkLit(v, true)] = 0;
+    ext_num_watched = 0;
+    ext_triggered.clear();
 }
 
 /*===== IPASIR-UP END ====================================================*/
@@ -28,6 +28,8 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/utils/Options.h"
 #include "minisat/core/SolverTypes.h"
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
 
@@ -55,6 +57,7 @@ public:
     //
     Var     newVar    (lbool upol = l_Undef, bool dvar = true); // Add a new variable with parameters specifying variable mode.
     void    releaseVar(Lit l);                                  // Make literal true and promise to never refer to variable again.
+    void    reserveVars(int n);                                 // Make room for 'n' variables in total (without creating them).
 
     bool    addClause (const vec<Lit>& ps);                     // Add a clause to the solver. 
     bool    addEmptyClause();                                   // Add the empty clause, making the solver contradictory.
@@ -139,6 +142,9 @@ public:
     double    random_seed;
     bool      luby_restart;
     int       ccmin_mode;         // Controls conflict clause minimization (0=none, 1=basic, 2=deep).
+    int       bin_min_lbd;        // Learnt clauses with an LBD up to this value are also minimized by binary clauses (0=off).
+    int       bin_min_size;       // Binary minimization is skipped for learnt clauses longer than this.
+    bool      use_implicit_bins;  // Keep binary clauses in 'bin_watches' outside the clause arena when possible (off with LRAT).
     int       phase_saving;       // Controls the level of phase saving (0=none, 1=limited, 2=full).
     bool      rnd_pol;            // Use random polarities for branching heuristics.
     bool      rnd_init_act;       // Initialize variable activities with a small random value.
@@ -147,23 +153,63 @@ public:
 
     int       restart_first;      // The initial restart limit.                                                                (default 100)
     double    restart_inc;        // The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
+    bool      ema_restart;        // Restart when recent learnt clauses have a high LBD instead of following 'restart_first'.  (default false)
+    double    restart_margin;     // Restart when the fast LBD average exceeds the slow one by this factor.                    (default 1.25)
+    double    restart_block;      // Postpone a restart when the trail is longer than its average by this factor.              (default 1.4)
+    int       restart_min_confl;  // The minimum number of conflicts between two moving average driven restarts.              (default 50)
+    uint64_t  restart_block_start;// Restarts are not postponed during the first conflicts.                                   (default 10000)
+
+    bool      stable_enabled;     // Alternate between the focused mode and a stable mode with few restarts and target phases. (default false)
+    bool      mode_ticks;         // Measure modes after the first one in propagation ticks instead of conflicts.             (default false)
+    int       mode_init;          // The number of conflicts of the first focused mode. Later modes grow geometrically.       (default 1000)
+    int       stable_restart_first; // The base (Luby) restart interval in stable mode.                                       (default 1024)
+    int       rephase_int;        // The base number of conflicts between rephasing when modes alternate (0=off).             (default 1000)
+    int       vmtf_mode;          // Decide with the VMTF queue instead of VSIDS (0=never, 1=in focused mode, 2=always).      (default 0)
+    int       chrono;             // Backtrack one level only when the backjump would undo more levels than this (0=off).    (default 0)
+    int       ext_prop_int;       // Ask the external propagator within 'propagate()' after this many observed assignments.  (default 0)
+    int       inprocess_int;      // The base number of conflicts between inprocessing rounds at restarts (0=off).           (default 0)
+    bool      inprocess_ticks;    // Measure the intervals after the first one in propagation ticks instead of conflicts.     (default false)
+    double    inprocess_frac;     // The maximal fraction of the search time spent on inprocessing.                          (default 0.1)
+    bool      probe_enabled;      // Probe the roots of the binary implication graph during inprocessing.                    (default true)
+    double    probe_effort;       // Probing may take this many propagation ticks per tick of search since the last round.   (default 0.2)
+    int       probe_hbr_lim;      // The maximal number of hyper-binary resolvents added per probing round.                  (default 1000)
+    bool      vivify_enabled;     // Vivify the core and tier-2 learnt clauses and the problem clauses during inprocessing.   (default true)
+    double    vivify_effort;      // Vivifying learnt clauses may take this many propagation ticks per tick of search.        (default 0.1)
+    double    vivify_irred_effort;// The same for the problem clauses, under a separate budget.                              (default 0.05)
     double    learntsize_factor;  // The intitial limit for learnt clauses is a factor of the original clauses.                (default 1 / 3)
     double    learntsize_inc;     // The limit for learnt clauses is multiplied with this factor each restart.                 (default 1.1)
 
     int       learntsize_adjust_start_confl;
     double    learntsize_adjust_inc;
 
+    int       core_lbd;           // Learnt clauses with an LBD up to this value are kept forever ('tier_core').          (default 2)
+    int       tier2_lbd;          // Learnt clauses with an LBD up to this value are kept while they are used ('tier_two'). (default 6)
+    int       tier2_interval;     // Number of conflicts between demotions of unused 'tier_two' clauses to 'tier_local'.    (default 10000)
+
+    // Retention tiers of learnt clauses. Only 'tier_local' is subject to the activity based 'reduceDB()':
+    //
+    enum { tier_core = 0, tier_two = 1, tier_local = 2 };
+
     // Statistics: (read-only member variable)
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
     uint64_t dec_vars, num_clauses, num_learnts, clauses_literals, learnts_literals, max_literals, tot_literals;
+    uint64_t num_tier[3];         // Number of learnt clauses in each tier.
+    uint64_t ticks, mode_switches, rephases, inprocessings;
+    double   inprocess_time;      // CPU time spent in 'inprocess()'.
+    uint64_t probes, failed_lits, hyper_bins;
+    uint64_t vivified, vivified_lits; // Clauses shortened (or removed) by vivification, and the literals removed.
 
 protected:
 
     // Helper structures:
     //
-    struct VarData { CRef reason; int level; };
-    static inline VarData mkVarData(CRef cr, int l){ VarData d = {cr, l}; return d; }
+    struct VarData { CRef reason; int level; Lit other; };
+    static inline VarData mkVarData(CRef cr, int l, Lit o = lit_Undef){ VarData d = {cr, l, o}; return d; }
+
+    // Reason (and conflict) marker for implicit binary clauses. For a reason, the other literal of
+    // the clause is found in 'vardata[x].other'; for a conflict, both literals are in 'bin_confl':
+    static constexpr CRef CRef_Bin = CRef_Undef - 3;
 
     struct Watcher {
         CRef cref;
@@ -173,6 +219,14 @@ protected:
         bool operator!=(const Watcher& w) const { return cref != w.cref; }
     };
 
+    struct BinWatcher {
+        Lit  other;
+        bool learnt;
+        BinWatcher(Lit p, bool l) : other(p), learnt(l) {}
+        bool operator==(const BinWatcher& w) const { return other == w.other && learnt == w.learnt; }
+        bool operator!=(const BinWatcher& w) const { return !(*this == w); }
+    };
+
     struct WatcherDeleted
     {
         const ClauseAllocator& ca;
@@ -186,12 +240,30 @@ protected:
         VarOrderLt(const IntMap<Var, double>&  act) : activity(act) { }
     };
 
+    struct VmtfLink { Var prev, next; };
+
+    struct VmtfStampLt {
+        const IntMap<Var, uint64_t>& stamp;
+        bool operator () (Var x, Var y) const { return stamp[x] < stamp[y]; }
+        VmtfStampLt(const IntMap<Var, uint64_t>& s) : stamp(s) { }
+    };
+
     struct ShrinkStackElem {
         uint32_t i;
         Lit      l;
         ShrinkStackElem(uint32_t _i, Lit _l) : i(_i), l(_l){}
     };
 
+    // Exponential moving average. Until '1/alpha' values have been seen it is the plain average:
+    struct EMA {
+        double   value;
+        double   alpha;
+        uint64_t n;
+        explicit EMA(double a) : value(0), alpha(a), n(0) {}
+        void     update(double x) { n++; value += (x - value) * (1.0 / n > alpha ? 1.0 / n : alpha); }
+        operator double() const   { return value; }
+    };
+
     // Solver state:
     //
     vec<CRef>           clauses;          // List of problem clauses.
@@ -208,8 +280,18 @@ protected:
     VMap<VarData>       vardata;          // Stores reason and level for each variable.
     OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>
                         watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    LMap<vec<BinWatcher> >
+                        bin_watches;      // 'bin_watches[lit]' holds the other literal of each implicit binary clause containing '~lit'.
+    Lit                 bin_confl[2];     // The literals of a conflicting implicit binary clause (see 'CRef_Bin').
 
     Heap<Var,VarOrderLt>order_heap;       // A priority queue of variables ordered with respect to the variable activity.
+    VMap<VmtfLink>      vmtf_links;       // Doubly linked VMTF queue, ordered by the time each variable was last bumped.
+    VMap<uint64_t>      vmtf_stamp;       // The time each variable was last moved to the end of the VMTF queue.
+    Var                 vmtf_first;       // Least recently bumped variable.
+    Var                 vmtf_last;        // Most recently bumped variable.
+    Var                 vmtf_unassigned;  // All variables after this one in the VMTF queue are assigned (or not decision variables).
+    uint64_t            vmtf_time;
+    bool                vmtf_active;      // Decisions are taken from the VMTF queue; 'order_heap' is not maintained.
 
     bool                ok;               // If FALSE, the constraints are already unsatisfiable. No part of the solver state may be used!
     double              cla_inc;          // Amount to bump next clause with.
@@ -219,6 +301,7 @@ protected:
     int64_t             simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplify()'.
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
+    bool                implicit_bins;    // Store new binary clauses in 'bin_watches' instead of the clause arena (off with LRAT and while 'SimpSolver' simplifies).
     Var                 next_var;         // Next variable to be created.
     ClauseAllocator     ca;
 
@@ -231,11 +314,44 @@ protected:
     VMap<char>          seen;
     vec<ShrinkStackElem>analyze_stack;
     vec<Lit>            analyze_toclear;
+    vec<Var>            analyze_bumped;
     vec<Lit>            add_tmp;
+    vec<Lit>            cancel_kept;      // Out-of-order literals kept on the trail by 'cancelUntil()'.
+    vec<uint64_t>       lbd_levels;       // Per decision level stamp used by 'computeLBD()'.
+    VMap<uint64_t>      bin_min_stamp;    // Per variable stamp used by 'binaryMinimize()'.
+    uint64_t            bin_min_time;
+    LMap<int>           bin_count;        // Number of binary clauses containing each literal (used by 'probe()').
+    LMap<char>          probe_mark;       // The literals implied by the current probe (used by 'probeLit()').
+    vec<Lit>            probe_lits, probe_implied, probe_hbr;
+    vec<uint64_t>       probe_hints, probe_ids;
+    vec<Lit>            vivify_lits;
+    vec<CRef>           vivify_cands, vivify_added;
+    uint64_t            lbd_stamp;
 
     double              max_learnts;
+    uint64_t            next_tier2_reduce; // Number of conflicts at which 'reduceTier2()' is run next.
     double              learntsize_adjust_confl;
     int                 learntsize_adjust_cnt;
+    EMA                 lbd_ema_fast;     // Moving averages of the LBD of learnt clauses, ...
+    EMA                 lbd_ema_slow;     // ... and of the trail size at conflicts, driving 'ema_restart'.
+    EMA                 trail_ema;
+
+    VMap<lbool>         target;           // Values of the longest conflict-free trail since the last restart, used as phases in stable mode.
+    VMap<lbool>         best;             // Values of the longest conflict-free trail since the last rephasing.
+    int                 target_assigned;  // Length of the trail 'target' was taken from.
+    int                 best_assigned;    // Length of the trail 'best' was taken from.
+    bool                stable;           // Currently in stable mode (see 'stable_enabled').
+    uint64_t            mode_start_conflicts, mode_start_ticks;
+    uint64_t            mode_unit;        // Length of the first mode, the unit of all later ones.
+    int                 stable_restarts;
+    uint64_t            next_rephase;     // Number of conflicts at which 'rephase()' is run next.
+    uint64_t            next_inprocess;   // Number of conflicts (or ticks, see 'inprocess_unit') at which 'inprocess()' is due next.
+    uint64_t            inprocess_unit;   // With 'inprocess_ticks', the ticks of the first interval (0 until then).
+    int                 inprocess_rounds; // Number of inprocessing rounds scheduled, including those skipped for lack of time.
+    double              search_time;      // CPU time spent in 'solve_()' by earlier calls.
+    int                 probe_next;       // The literal (as an index) at which the next probing round starts.
+    uint64_t            probe_ticks;      // Value of 'ticks' at the end of the last probing round.
+    uint64_t            vivify_ticks;     // Value of 'ticks' at the end of the last vivification round.
 
     // Resource contraints:
     //
@@ -246,19 +362,42 @@ protected:
     // Main internal methods:
     //
     void     insertVarOrder   (Var x);                                                 // Insert a variable in the decision order priority queue.
+    void     vmtfEnqueue      (Var x);                                                 // Append a variable to the end of the VMTF queue.
+    void     vmtfBump         (Var x);                                                 // Move a variable to the end of the VMTF queue.
+    void     selectDecisionQueue();                                                    // Switch between VSIDS and VMTF according to 'vmtf_mode'.
     Lit      pickBranchLit    ();                                                      // Return the next decision variable.
     void     newDecisionLevel ();                                                      // Begins a new decision level.
-    void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef);                         // Enqueue a literal. Assumes value of literal is undefined.
+    void     newProbeLevel    ();                                                      // Begins a decision level for probing at level 0 (not seen by the external propagator).
+    void     cancelProbe      ();                                                      // Backtrack from a probe to level 0.
+    void     uncheckedEnqueue (Lit p, CRef from = CRef_Undef, Lit other = lit_Undef);  // Enqueue a literal. Assumes value of literal is undefined.
+    void     uncheckedEnqueue (Lit p, int level, CRef from, Lit other = lit_Undef);     // Enqueue a literal implied at a lower level (out of order, see 'chrono').
     bool     enqueue          (Lit p, CRef from = CRef_Undef);                         // Test if fact 'p' contradicts current state, enqueue otherwise.
     CRef     propagate        ();                                                      // Perform unit propagation. Returns possibly conflicting clause.
     void     cancelUntil      (int level);                                             // Backtrack until a certain level.
-    void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
+    void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel, int& out_lbd); // (bt = backtrack)
+    int      conflictLevel    (CRef confl, Lit& forced);                               // The highest level in a conflict, and its only literal there (if so).
+    void     moveWatch        (CRef cr, int i, int k);                                 // Move literal 'i' of a clause to the watched position 'k'.
     void     analyzeFinal     (Lit p, LSet& out_conflict);                             // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p);                                                 // (helper method for 'analyze()')
+    bool     binaryMinimize   (vec<Lit>& out_learnt);                                  // (helper method for 'analyze()')
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
+    bool     restartEMA       (int conflictC) const;                                   // Do the LBD moving averages call for a restart?
+    bool     modeSwitchDue    () const;                                                // Has the current search mode run its course?
+    void     switchMode       ();                                                      // Switch between focused and stable mode.
+    void     updatePhases     (int assigned);                                          // Record the first 'assigned' trail values as target/best phases.
+    void     rephase          ();                                                      // Reset the saved phases (original, inverted, best or random).
+    bool     inprocessDue     () const;                                                // Is the next inprocessing round due?
+    bool     inprocessRound   (double solve_start);                                    // Run 'inprocess()' within its time budget and schedule the next round.
+    bool     probe            ();                                                      // Failed literal probing with hyper-binary resolution (at level 0).
+    bool     probeLit         (Lit p, int& hbr_budget);                                // Probe 'p' (and '~p', for necessary assignments).
+    bool     probeUnit        (Lit p, CRef confl);                                     // Learn the unit '~p' from a conflict of the probe 'p'.
+    bool     vivify           (bool irredundant);                                      // Shorten learnt (and with 'irredundant', problem) clauses by propagation.
+    bool     vivifyClause     (CRef cr);                                               // Vivify one clause (see 'vivify()').
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
+    void     reduceTier2      ();                                                      // Demote unused tier-2 learnt clauses to the local tier.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
+    void     removeSatisfiedBins(bool originals);                                      // Remove satisfied implicit binaries (only learnt ones unless 'originals').
     void     rebuildOrderHeap ();
 
     // Maintaining Variable/Clause activity:
@@ -269,9 +408,21 @@ protected:
     void     claDecayActivity ();                      // Decay all clauses with the specified factor. Implemented by increasing the 'bump' value instead.
     void     claBumpActivity  (Clause& c);             // Increase a clause with the current 'bump' value.
 
+    // Learnt clause tiers:
+    //
+    template<class Lits>
+    int      computeLBD       (const Lits& c);         // Number of distinct decision levels in 'c' (the literal block distance).
+    unsigned lbdTier          (int lbd) const;         // The tier a learnt clause with the given LBD belongs to.
+    void     setTier          (Clause& c, unsigned t); // Move an attached learnt clause to another tier.
+
     // Operations on clauses:
     //
+    bool     addClause_       (vec<Lit>& ps, uint64_t id); // Add a clause that is already in the proof (under the LRAT ID 'id').
     void     attachClause     (CRef cr);               // Attach a clause to watcher lists.
+    void     attachBinary     (Lit p, Lit q, bool learnt); // Add the implicit binary clause (p \/ q).
+    void     makeBinariesImplicit();                   // Move all binary clauses out of the clause arena into 'bin_watches'.
+    void     makeBinariesExplicit();                   // Move the binary problem clauses from 'bin_watches' back into the clause arena.
+    void     makeBinariesExplicit(const vec<Var>& vs); // Move only those containing a variable of 'vs'.
     void     detachClause     (CRef cr, bool strict = false); // Detach a clause to watcher lists.
     void     removeClause     (CRef cr);               // Detach and free a clause.
     bool     isRemoved        (CRef cr) const;         // Test if a clause has been removed.
@@ -285,12 +436,33 @@ protected:
     CRef     reason           (Var x) const;
     bool     isReasonLazy     (Var x) const;
     CRef     reasonLazy       (Var x);
+    const Lit* reasonLits     (Var x, Lit* bin, int& size); // Literals of the reason for 'x' (implied literal first).
     int      level            (Var x) const;
     int      level            (Lit l) const;
     double   progressEstimate ()      const; // DELETE THIS ?? IT'S NOT VERY USEFUL ...
     bool     withinBudget     ()      const;
     void     relocAll         (ClauseAllocator& to);
 
+    // Clause sharing (see 'PortfolioSolver'). 'exportLearnt()' is called for every learnt clause if
+    // 'share_learnts' is set and 'importLearnts()' at decision level 0, where it may add clauses
+    // through 'addLearnt_()':
+    //
+    bool         share_learnts = false;
+    virtual void exportLearnt (const vec<Lit>& c, int lbd) { (void)c; (void)lbd; }
+    virtual bool importLearnts() { return true; }
+    bool     addLearnt_       (vec<Lit>& ps, int lbd, uint64_t id = 0);
+
+    // Inprocessing, run at decision level 0 between restarts every 'inprocess_int' conflicts (see
+    // 'inprocessRound()'). Returns FALSE if the problem was found to be unsatisfiable:
+    //
+    virtual bool inprocess    ();
+
+    // Mark a variable as observed by the external propagator or not (see 'add_observed_var()').
+    // Overridden by 'SimpSolver', which does not eliminate observed variables:
+    //
+    virtual void setObserved  (Var v, bool b);
+    bool         isObserved   (Var v) const;
+
     // Static helpers:
     //
 
@@ -305,30 +477,179 @@ protected:
     static inline int irand(double& seed, int size) {
         return (int)(drand(seed) * size); }
 
-    // Proof output
+    // Proof output (DRAT or LRAT, buffered; the buffer is flushed to 'output' at the end of every 'solve()')
 public:
     FILE* output = NULL;
+    bool  binary_proof;             // Write the proof in binary DRAT format instead of text.
+    bool  lrat;                     // Write the proof in LRAT format: every clause gets an ID and every lemma lists its antecedents.
+    bool  async_proof;              // Encode and write the proof on a separate thread.
     vec<Lit> oc;
+    void outputFlush();             // Write the buffered part of the proof to 'output' (and wait for the proof thread to do so).
+    void outputPrintEmptyClause() { if (!lrat){ outputBegin('a'); outputEnd(); } outputFlush(); } // (in LRAT mode the solver has already derived it)
+
+    // LRAT: original clauses are numbered 1, 2, ... in the order they are given to 'addClause()', and the
+    // clauses derived by the solver are numbered after them. If not all original clauses are added up front
+    // (e.g. some are only provided later by the external propagator), their number must be announced first:
+    void reserveOriginalIds(uint64_t n) { if (next_id < n) next_id = n; }
 private:
-    void outputPrintClause(const vec<Lit>& ps) {
-        for (int i = 0; i < ps.size(); i++)
-            fprintf(output, "%i ", LitToint(ps[i]));
-        fprintf(output, "0\n");
+    enum { output_buf_size = 1 << 20 };
+    vec<char> output_buf;
+    int       output_used = 0;
+
+    uint64_t       orig_ids = 0;    // Number of original clauses added so far.
+    uint64_t       next_id  = 0;    // The last ID given to a derived clause.
+    VMap<uint64_t> unit_id;         // ID of the unit clause of each variable assigned at level 0 (0 if not derived yet).
+    int            unit_head = 0;   // Every variable on the trail before this index has its unit clause derived.
+    vec<uint64_t>  lrat_hints, lrat_reasons, unit_hints;
+    vec<Lit>       unit_lits;
+    vec<Var>       lrat_toclear;
+
+    uint64_t newId() { return next_id = (next_id > orig_ids ? next_id : orig_ids) + 1; }
+
+    // Asynchronous output: the output primitives below are queued as records of words in a single
+    // producer/single consumer ring, and the proof thread replays them into 'output_buf'. The ring
+    // is published at the end of every proof line (or when it is full); 'outputFlush()' waits until
+    // the proof thread has written everything queued before it.
+    enum { ring_size = 1 << 20, ring_mask = ring_size - 1 };    // (in words)
+    enum { op_begin, op_num, op_lit, op_end, op_end_line, op_file, op_flush, op_stop };
+    uint32_t*             ring = NULL;
+    std::atomic<uint64_t> ring_head{0};     // Number of words published by the solver.
+    std::atomic<uint64_t> ring_tail{0};     // Number of words consumed by the proof thread.
+    uint64_t              ring_local = 0;   // Number of words written by the solver (published or not).
+    FILE*                 ring_file  = NULL;// The file the queued output goes to (as last queued).
+    FILE*                 proof_file = NULL;// The file the proof thread writes to.
+    std::thread           proof_thread;
+
+    void startProofThread();
+    void stopProofThread();
+    void proofThreadMain();
+    void ringPublish() { ring_head.store(ring_local, std::memory_order_release); }
+    void ringReserve(int n) {
+        // Wait for room for 'n' more words:
+        if (ring_local + n - ring_tail.load(std::memory_order_acquire) > ring_size){
+            ringPublish();
+            while (ring_local + n - ring_tail.load(std::memory_order_acquire) > ring_size)
+                std::this_thread::yield(); }
+    }
+    void ringPush(uint32_t w) { ring[ring_local++ & ring_mask] = w; }
+    void ringQueue(int n) {
+        if (ring == NULL) startProofThread();
+        if (output != ring_file){
+            ring_file = output;
+            ringReserve(3);
+            ringPush(op_file);
+            ringPush((uint32_t)(uintptr_t)output);
+            ringPush((uint32_t)((uint64_t)(uintptr_t)output >> 32)); }
+        ringReserve(n);
+    }
+
+    // Output primitives (encoded right away, or queued for the proof thread):
+    void outputBegin(char tag)                    { if (async_proof){ ringQueue(1); ringPush(op_begin | (uint8_t)tag << 8); } else encodeBegin(tag); }
+    void outputNum(uint64_t u, bool neg = false)  { if (async_proof){ ringQueue(3); ringPush(op_num | neg << 8); ringPush((uint32_t)u); ringPush((uint32_t)(u >> 32)); } else encodeNum(u, neg); }
+    void outputLit(Lit p)                         { if (async_proof){ ringQueue(2); ringPush(op_lit); ringPush(toInt(p)); } else encodeLit(p); }
+    void outputEnd()                              { if (async_proof){ ringQueue(1); ringPush(op_end); ringPublish(); } else encodeEnd(); }
+    void outputEndLine()                          { if (async_proof){ ringQueue(1); ringPush(op_end_line); ringPublish(); } else encodeEndLine(); }
+
+    // Encoding into 'output_buf':
+    void writeBuffer();             // Write 'output_buf' to the proof file.
+    void encodeBegin(char tag) {
+        if (output_used + 2 > output_buf.size()) writeBuffer();
+        if (binary_proof && !lrat)
+            output_buf[output_used++] = tag;
+        else if (tag == 'd'){
+            output_buf[output_used++] = 'd';
+            output_buf[output_used++] = ' '; }
     }
-    void outputPrintClause(const Clause& c) {
+    void encodeNum(uint64_t u, bool neg) {
+        // Text: a decimal number followed by a space.
+        if (output_used + 24 > output_buf.size()) writeBuffer();
+        char* b = &output_buf[output_used];
+        char  tmp[20];
+        int   n = 0;
+        if (neg) *b++ = '-';
+        do { tmp[n++] = '0' + u % 10; u /= 10; } while (u > 0);
+        while (n > 0) *b++ = tmp[--n];
+        *b++ = ' ';
+        output_used = b - &output_buf[0];
+    }
+    void encodeLit(Lit p) {
+        if (!binary_proof){
+            encodeNum(var(p) + 1, sign(p));
+            return; }
+        if (output_used + 8 > output_buf.size()) writeBuffer();
+        // Variable-length encoding of '2 * (var + 1) + sign', 7 bits per byte:
+        char* b = &output_buf[output_used];
+        uint32_t u = 2 * (var(p) + 1) + sign(p);
+        for (; u > 127; u >>= 7)
+            *b++ = (char)(128 | (u & 127));
+        *b++ = (char)u;
+        output_used = b - &output_buf[0];
+    }
+    void encodeEndLine() {
+        if (output_used + 2 > output_buf.size()) writeBuffer();
+        output_buf[output_used++] = '0';
+        output_buf[output_used++] = '\n';
+    }
+    void encodeEnd() {
+        if (!binary_proof){
+            encodeEndLine();
+            return; }
+        if (output_used + 1 > output_buf.size()) writeBuffer();
+        output_buf[output_used++] = 0;
+    }
+
+    template<class Lits>
+    void outputPrintLits(char tag, const Lits& c) {
+        outputBegin(tag);
         for (int i = 0; i < c.size(); i++)
-            fprintf(output, "%i ", LitToint(c[i]));
-        fprintf(output, "0\n");
+            outputLit(c[i]);
+        outputEnd();
+    }
+    void outputPrintClause(const vec<Lit>& ps)        { outputPrintLits('a', ps); }
+    void outputPrintClause(const Clause& c)           { outputPrintLits('a', c); }
+    void outputPrintClauseDeleted(const vec<Lit>& ps) { outputPrintLits('d', ps); }
+    void outputPrintClauseDeleted(const Clause& c)    { outputPrintLits('d', c); }
+    void outputPrintClauseDeleted(Lit p, Lit q) {
+        outputBegin('d');
+        outputLit(p);
+        outputLit(q);
+        outputEnd();
     }
-    void outputPrintClauseDeleted(const vec<Lit>& ps) {
-        fprintf(output, "d ");
-        outputPrintClause(ps);
+
+    // LRAT (always text): 'id lits 0 hints 0' for a lemma, 'id d ids 0' for a deletion.
+    template<class Lits>
+    void outputLrat(uint64_t id, const Lits& c, const vec<uint64_t>& hints) {
+        outputNum(id);
+        for (int i = 0; i < c.size(); i++)
+            outputNum(var(c[i]) + 1, sign(c[i]));
+        outputNum(0);
+        for (int i = 0; i < hints.size(); i++)
+            outputNum(hints[i]);
+        outputEndLine();
     }
-    void outputPrintClauseDeleted(const Clause& c) {
-        fprintf(output, "d ");
-        outputPrintClause(c);
+    void outputLratDeleted(uint64_t id) {
+        outputNum(next_id > orig_ids ? next_id : orig_ids);
+        outputBegin('d');
+        outputNum(id);
+        outputEndLine();
     }
 
+protected:
+    uint64_t originalId       () { return ++orig_ids; }       // The LRAT ID of the next original clause.
+    uint64_t unitId           (Var x);                         // ID of the unit clause of 'x' (assigned at level 0), derived on demand.
+    void     lratUnitsDerived ();                              // Derive the unit clauses of the whole level 0 trail.
+    template<class Lits>
+    void     lratUnits        (const Lits& c, vec<uint64_t>& hints); // Append the unit clauses falsifying literals of 'c' at level 0.
+    void     lratChain        (CRef confl, const vec<Lit>& c, vec<uint64_t>& hints); // Antecedents of the learnt clause 'c'.
+    void     lratEmptyClause  (CRef confl);                    // Derive the empty clause from a conflict at level 0.
+    uint64_t lratExternal     (const vec<Lit>& orig, const vec<Lit>& ps); // Write a clause of the external propagator (and its trimmed version 'ps').
+
+    // Proof output of simplifications at level 0 (see 'SimpSolver'). A lemma must follow from the clauses
+    // before it by unit propagation; for LRAT, 'hints' are its antecedents (see 'lratChain()'):
+    uint64_t proofLemma       (const vec<Lit>& c, const vec<uint64_t>& hints); // Write the lemma 'c'; returns its LRAT ID.
+    void     proofDeleted     (const Clause& c);               // Write the deletion of 'c'.
+    void     proofDeleted     (const vec<Lit>& c, uint64_t id); // Write the deletion of the lemma 'c' (with the LRAT ID 'id').
+
     // ====== BEGIN IPASIR-UP ================================================
 private:
     static constexpr CRef CRef_External_True = CRef_Undef - 1;
@@ -338,6 +659,18 @@ protected:
 private:
     int notify_assignment_index = 0;
     bool notify_backtrack = false;
+    VMap<char> observed;               // Only the assignments of observed variables are notified.
+    std::vector<int> notify_trail;     // The notified (observed) part of the trail as DIMACS literals.
+    std::vector<size_t> notify_lim;    // Size of 'notify_trail' at the start of each notified decision level.
+    LMap<char> ext_watched;            // The literals watched by the external propagator (see 'add_watched_lit()').
+    int ext_num_watched = 0;
+    std::vector<int> ext_triggered;    // Watched literals assigned since the propagator was last called.
+    bool ext_wake = false;             // Call the propagator even if no watched literal was assigned.
+    void notifyAssignments();
+    void notifyWatched();
+    lbool propagateExternal(CRef& confl);
+    bool ext_prop_active = false;      // Is 'propagate()' called by 'search()' (see 'ext_prop_int')?
+    int ext_prop_pending = 0;          // Observed assignments propagated since the last call from 'propagate()'.
 private:
     std::vector<int> getCurrentModel();
 private:
@@ -391,6 +724,21 @@ public:
     //
     void reset_observed_vars ();
 
+    // Watch a literal of an observed variable for the external propagator.
+    // As long as any literals are watched, the propagator is asked for
+    // propagations and clauses only after a watched literal was assigned
+    // (true), or after 'cb_check_found_model' rejected a model, instead of
+    // after every round of propagation. It keeps being asked until neither
+    // gives anything. The triggering literals are passed to it before with
+    // 'notify_watched'.
+    //
+    //   require (VALID_OR_SOLVING)
+    //   ensure (VALID_OR_SOLVING)
+    //
+    void add_watched_lit (int lit);
+    void remove_watched_lit (int lit);
+    void reset_watched_lits ();
+
     // Get reason of valid observed literal (true = it is an observed variable
     // and it got assigned by a decision during the CDCL loop. Otherwise:
     // false.
@@ -432,11 +780,29 @@ public:
     // the call of propagator callbacks and when a driving clause is leading
     // to an assignment.
     //
+    // The literals are passed as a view into a buffer of the solver, which
+    // is only valid during the call. By default it is forwarded to the
+    // vector variant below, which copies it (kept for compatibility). A
+    // propagator overriding the view variant still has to define the vector
+    // variant, e.g. by forwarding it to the view variant.
+    //
     // virtual void notify_assignment (int lit, bool is_fixed) = 0;
+    virtual void notify_assignment(const int* lits, size_t size) {
+        notify_assignment(std::vector<int>(lits, lits + size));
+    }
     virtual void notify_assignment(const std::vector<int>& lits) = 0;
     virtual void notify_new_decision_level() = 0;
     virtual void notify_backtrack(size_t new_level) = 0;
 
+    // Notify the propagator about the watched literals (see
+    // 'Solver::add_watched_lit') that were assigned since its last wake-up
+    // and are still true, possibly repeated. It is called right before
+    // 'cb_propagate_lits' (only when literals are watched).
+    //
+    virtual void notify_watched(const int* lits, size_t size) {
+        (void)lits; (void)size;
+    }
+
     // Check by the external propagator the found complete solution (after
     // solution reconstruction). If it returns false, the propagator must
     // provide an external clause during the next callback.
@@ -511,7 +877,48 @@ public:
 
     // The actual function called to add the external clause.
     //
-    virtual int cb_add_external_clause_lit() = 0;
+    virtual int cb_add_external_clause_lit() { return 0; }
+
+    // Batched variants of 'cb_propagate', 'cb_add_reason_clause_lit' and
+    // 'cb_add_external_clause_lit', which are the ones called by the solver.
+    // The literals are returned as a view into a buffer of the propagator,
+    // which must stay valid until its next callback. By default they are
+    // collected from the single-literal callbacks above.
+    //
+    // 'cb_propagate_lits' returns all literals to be propagated under the
+    // current assignment ('size' is 0 if there are none). The solver assigns
+    // them (skipping those already true) before it propagates. A literal
+    // that is false already is a conflict, whose reason the solver learns
+    // like an external clause (only the first one is handled). If 'reasons'
+    // is set, it holds their reason clauses in the same order, each closed
+    // with a 0, and the solver learns them right away instead of asking for
+    // them later with 'cb_add_reason_clause'. With the 'ext-prop-int' option
+    // it is also called during unit propagation, before the fixpoint.
+    //
+    virtual const int* cb_propagate_lits(size_t& size, const int*& reasons) {
+        batch_lit = cb_propagate();
+        size = batch_lit != 0;
+        reasons = nullptr;
+        return &batch_lit;
+    }
+    virtual const int* cb_add_reason_clause(int propagated_lit, size_t& size) {
+        batch_clause.clear();
+        while (int lit = cb_add_reason_clause_lit(propagated_lit))
+            batch_clause.push_back(lit);
+        size = batch_clause.size();
+        return batch_clause.data();
+    }
+    virtual const int* cb_add_external_clause(size_t& size) {
+        batch_clause.clear();
+        while (int lit = cb_add_external_clause_lit())
+            batch_clause.push_back(lit);
+        size = batch_clause.size();
+        return batch_clause.data();
+    }
+
+private:
+    int              batch_lit = 0;
+    std::vector<int> batch_clause;
 };
 
 
@@ -524,23 +931,36 @@ inline CRef Solver::reasonLazy(Var x) {
     if (external_propagator) {
         if (isReasonLazy(x)) {
             Lit l = mkLit(x, vardata[x].reason == CRef_External_False);
-            int unit = LitToint(l);
+            size_t size;
+            const int* lits = external_propagator->cb_add_reason_clause(LitToint(l), size);
             add_tmp.clear();
-            int lit;
-            while (lit = external_propagator->cb_add_reason_clause_lit(unit)) {
-                add_tmp.push(intToLit(lit));
-            }
+            for (size_t i = 0; i < size; i++)
+                add_tmp.push(intToLit(lits[i]));
             vardata[x].reason = add_clause_lazy(l, add_tmp);
         }
     }
     return vardata[x].reason;
 }
+inline const Lit* Solver::reasonLits(Var x, Lit* bin, int& size) {
+    CRef cr = reasonLazy(x);
+    if (cr == CRef_Bin){
+        bin[0] = mkLit(x, value(x) == l_False);
+        bin[1] = vardata[x].other;
+        size   = 2;
+        return bin; }
+    const Clause& c = ca[cr];
+    size = c.size();
+    return c;
+}
 
 inline int  Solver::level (Var x) const { return vardata[x].level; }
 inline int  Solver::level (Lit l) const { return level(var(l)); }
 
 inline void Solver::insertVarOrder(Var x) {
-    if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
+    if (vmtf_active){
+        if (decision[x] && (vmtf_unassigned == var_Undef || vmtf_stamp[x] > vmtf_stamp[vmtf_unassigned]))
+            vmtf_unassigned = x;
+    }else if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
 
 inline void Solver::varDecayActivity() { var_inc *= (1 / var_decay); }
 inline void Solver::varBumpActivity(Var v) { varBumpActivity(v, var_inc); }
@@ -552,17 +972,61 @@ inline void Solver::varBumpActivity(Var v, double inc) {
         var_inc *= 1e-100; }
 
     // Update order_heap with respect to new activity:
-    if (order_heap.inHeap(v))
+    if (vmtf_active)
+        analyze_bumped.push(v);
+    else if (order_heap.inHeap(v))
         order_heap.decrease(v); }
 
 inline void Solver::claDecayActivity() { cla_inc *= (1 / clause_decay); }
 inline void Solver::claBumpActivity (Clause& c) {
-        if ( (c.activity() += cla_inc) > 1e20 ) {
+        c.activity(c.activity() + cla_inc);
+        if ( c.activity() > 1e20 ) {
             // Rescale:
-            for (int i = 0; i < learnts.size(); i++)
-                ca[learnts[i]].activity() *= 1e-20;
+            for (int i = 0; i < learnts.size(); i++){
+                Clause& d = ca[learnts[i]];
+                d.activity(d.activity() * 1e-20f); }
             cla_inc *= 1e-20; } }
 
+template<class Lits>
+inline int Solver::computeLBD(const Lits& c) {
+    int lbd = 0;
+    lbd_stamp++;
+    for (int i = 0; i < c.size(); i++){
+        int l = level(var(c[i]));
+        if (l >= lbd_levels.size())
+            lbd_levels.growTo(l + 1, 0);
+        if (lbd_levels[l] != lbd_stamp){
+            lbd_levels[l] = lbd_stamp;
+            lbd++; }
+    }
+    return lbd; }
+
+template<class Lits>
+inline void Solver::lratUnits(const Lits& c, vec<uint64_t>& hints) {
+    int start = lrat_toclear.size();
+    for (int i = 0; i < c.size(); i++){
+        Var x = var(c[i]);
+        if (value(c[i]) == l_False && level(x) == 0 && !seen[x]){
+            seen[x] = 1;
+            lrat_toclear.push(x);
+            hints.push(unitId(x)); }
+    }
+    for (int i = start; i < lrat_toclear.size(); i++)
+        seen[lrat_toclear[i]] = 0;
+    lrat_toclear.shrink(lrat_toclear.size() - start); }
+
+inline unsigned Solver::lbdTier(int lbd) const {
+    return lbd <= core_lbd ? tier_core : lbd <= tier2_lbd ? tier_two : tier_local; }
+
+inline void Solver::setTier(Clause& c, unsigned t) {
+    assert(c.learnt());
+    num_tier[c.tier()]--;
+    num_tier[t]++;
+    c.tier(t); }
+
+inline bool Solver::restartEMA(int conflictC) const {
+    return ema_restart && !stable && conflictC >= restart_min_confl && lbd_ema_fast > restart_margin * lbd_ema_slow; }
+
 inline void Solver::checkGarbage(void){ return checkGarbage(garbage_frac); }
 inline void Solver::checkGarbage(double gf){
     if (ca.wasted() > ca.size() * gf)
@@ -578,7 +1042,8 @@ inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r, Lit s){ add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); add_tmp.push(s); return addClause_(add_tmp); }
 
 inline bool     Solver::isRemoved       (CRef cr)         const { return ca[cr].mark() == 1; }
-inline bool     Solver::locked          (const Clause& c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && !isReasonLazy(var(c[0])) && ca.lea(reason(var(c[0]))) == &c; }
+inline bool     Solver::isObserved      (Var v)           const { return observed[v]; }
+inline bool     Solver::locked          (const Clause& c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && reason(var(c[0])) != CRef_Bin && !isReasonLazy(var(c[0])) && ca.lea(reason(var(c[0]))) == &c; }
 inline void     Solver::newDecisionLevel()                      {
     trail_lim.push(trail.size());
     if (external_propagator) {
@@ -586,6 +1051,14 @@ inline void     Solver::newDecisionLevel()                      {
     }
 }
 
+inline void     Solver::newProbeLevel   ()                      { assert(decisionLevel() == 0); trail_lim.push(trail.size()); }
+inline void     Solver::cancelProbe     ()                      {
+    ExternalPropagator* ep = external_propagator;
+    external_propagator    = nullptr;
+    cancelUntil(0);
+    external_propagator    = ep;
+}
+
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
 inline uint32_t Solver::abstractLevel (Var x) const   { return 1 << (level(x) & 31); }
 inline lbool    Solver::value         (Var x) const   { return assigns[x]; }
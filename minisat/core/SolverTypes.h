@@ -147,17 +147,22 @@ class Clause {
         unsigned learnt    : 1;
         unsigned has_extra : 1;
         unsigned reloced   : 1;
-        unsigned size      : 27; }                        header;
+        unsigned vivified  : 1;
+        unsigned has_id    : 1;
+        unsigned size      : 25; }                        header;
     union { Lit lit; float act; uint32_t abs; CRef rel; } data[0];
 
     friend class ClauseAllocator;
 
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
-    Clause(const vec<Lit>& ps, bool use_extra, bool learnt) {
+    Clause(const vec<Lit>& ps, bool use_extra, bool learnt, bool use_id, uint64_t cid) {
+        assert(ps.size() < (1 << 25));
         header.mark      = 0;
         header.learnt    = learnt;
         header.has_extra = use_extra;
         header.reloced   = 0;
+        header.vivified  = 0;
+        header.has_id    = use_id;
         header.size      = ps.size();
 
         for (int i = 0; i < ps.size(); i++) 
@@ -165,10 +170,12 @@ class Clause {
 
         if (header.has_extra){
             if (header.learnt)
-                data[header.size].act = 0;
+                data[header.size].abs = 0;  // (zero activity and bookkeeping)
             else
                 calcAbstraction();
     }
+        if (header.has_id)
+            id(cid);
     }
 
     // NOTE: This constructor cannot be used directly (doesn't allocate enough memory).
@@ -181,10 +188,14 @@ class Clause {
 
         if (header.has_extra){
             if (header.learnt)
-                data[header.size].act = from.data[header.size].act;
-            else 
                 data[header.size].abs = from.data[header.size].abs;
+            else if (from.header.has_extra)
+                data[header.size].abs = from.data[header.size].abs;
+            else
+                calcAbstraction();  // (the copy gains the extra field)
     }
+        if (header.has_id)
+            id(from.id());
     }
 
 public:
@@ -197,7 +208,7 @@ public:
 
 
     int          size        ()      const   { return header.size; }
-    void         shrink      (int i)         { assert(i <= size()); if (header.has_extra) data[header.size-i] = data[header.size]; header.size -= i; }
+    void         shrink      (int i)         { assert(i <= size()); for (int k = 0; k < header.has_extra + 2*header.has_id; k++) data[header.size-i+k] = data[header.size+k]; header.size -= i; }
     void         pop         ()              { shrink(1); }
     bool         learnt      ()      const   { return header.learnt; }
     bool         has_extra   ()      const   { return header.has_extra; }
@@ -205,6 +216,19 @@ public:
     void         mark        (uint32_t m)    { header.mark = m; }
     const Lit&   last        ()      const   { return data[header.size-1].lit; }
 
+    // Learnt clause bookkeeping: literal block distance (saturating at 'lbd_max'), retention tier and
+    // usage since the tier was last reviewed. It is kept in the low 8 bits of the extra field, below
+    // the activity (see 'activity()'):
+    enum { lbd_max = 31 };
+    unsigned     lbd         ()      const   { return meta() & lbd_max; }
+    void         lbd         (unsigned l)    { meta(0x1F, l < lbd_max ? l : lbd_max); }
+    unsigned     tier        ()      const   { return (meta() >> 5) & 3; }
+    void         tier        (unsigned t)    { meta(0x60, t << 5); }
+    bool         used        ()      const   { return (meta() >> 7) & 1; }
+    void         used        (bool u)        { meta(0x80, (uint32_t)u << 7); }
+    bool         vivified    ()      const   { return header.vivified; }
+    void         vivified    (bool v)        { header.vivified = v; }
+
     bool         reloced     ()      const   { return header.reloced; }
     CRef         relocation  ()      const   { return data[0].rel; }
     void         relocate    (CRef c)        { header.reloced = 1; data[0].rel = c; }
@@ -215,11 +239,23 @@ public:
     Lit          operator [] (int i) const   { return data[i].lit; }
     operator const Lit* (void) const         { return (Lit*)data; }
 
-    float&       activity    ()              { assert(header.has_extra); return data[header.size].act; }
+    // The activity of a learnt clause is a float with its lowest 8 mantissa bits cut off (for the
+    // bookkeeping above):
+    float        activity    ()      const   { assert(header.learnt); union { uint32_t abs; float act; } w; w.abs = data[header.size].abs & ~(uint32_t)0xFF; return w.act; }
+    void         activity    (float a)       { assert(header.learnt); union { uint32_t abs; float act; } w; w.act = a; meta(~(uint32_t)0xFF, w.abs); }
     uint32_t     abstraction () const        { assert(header.has_extra); return data[header.size].abs; }
 
+    // Clause ID for LRAT proofs, kept in two words after the extra field:
+    bool         has_id      ()      const   { return header.has_id; }
+    uint64_t     id          ()      const   { assert(header.has_id); int k = header.size + header.has_extra; return data[k].abs | (uint64_t)data[k+1].abs << 32; }
+    void         id          (uint64_t x)    { assert(header.has_id); int k = header.size + header.has_extra; data[k].abs = (uint32_t)x; data[k+1].abs = (uint32_t)(x >> 32); }
+
     Lit          subsumes    (const Clause& other) const;
     void         strengthen  (Lit p);
+
+private:
+    uint32_t     meta        ()      const   { assert(header.learnt); return data[header.size].abs; }
+    void         meta        (uint32_t mask, uint32_t bits) { assert(header.learnt); data[header.size].abs = (data[header.size].abs & ~mask) | (bits & mask); }
 };
 
 
@@ -231,36 +267,39 @@ class ClauseAllocator
 {
     RegionAllocator<uint32_t> ra;
 
-    static uint32_t clauseWord32Size(int size, bool has_extra){
-        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra))) / sizeof(uint32_t); }
+    static uint32_t clauseWord32Size(int size, bool has_extra, bool has_id){
+        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra + 2*(int)has_id))) / sizeof(uint32_t); }
 
  public:
     enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
 
     bool extra_clause_field;
+    bool clause_ids;            // Give every new clause an ID field (for LRAT proofs).
 
-    ClauseAllocator(uint32_t start_cap) : ra(start_cap), extra_clause_field(false){}
-    ClauseAllocator() : extra_clause_field(false){}
+    ClauseAllocator(uint32_t start_cap) : ra(start_cap), extra_clause_field(false), clause_ids(false){}
+    ClauseAllocator() : extra_clause_field(false), clause_ids(false){}
 
     void moveTo(ClauseAllocator& to){
         to.extra_clause_field = extra_clause_field;
+        to.clause_ids         = clause_ids;
         ra.moveTo(to.ra); }
 
-    CRef alloc(const vec<Lit>& ps, bool learnt = false)
+    CRef alloc(const vec<Lit>& ps, bool learnt = false, uint64_t id = 0)
     {
         assert(sizeof(Lit)      == sizeof(uint32_t));
         assert(sizeof(float)    == sizeof(uint32_t));
         bool use_extra = learnt | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra));
-        new (lea(cid)) Clause(ps, use_extra, learnt);
+        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra, clause_ids));
+        new (lea(cid)) Clause(ps, use_extra, learnt, clause_ids, id);
 
         return cid;
     }
 
+    // NOTE: the copy keeps the ID of 'from', if it has one.
     CRef alloc(const Clause& from)
     {
         bool use_extra = from.learnt() | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra));
+        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra, from.has_id()));
         new (lea(cid)) Clause(from, use_extra);
         return cid; }
 
@@ -277,7 +316,7 @@ class ClauseAllocator
     void free(CRef cid)
     {
         Clause& c = operator[](cid);
-        ra.free(clauseWord32Size(c.size(), c.has_extra()));
+        ra.free(clauseWord32Size(c.size(), c.has_extra(), c.has_id()));
     }
 
     void reloc(CRef& cr, ClauseAllocator& to)
@@ -340,6 +379,7 @@ class OccLists
         deleted(d){}
     
     void  init      (const K& idx){ occs.reserve(idx); occs[idx].clear(); dirty.reserve(idx, 0); }
+    void  capacity  (int n)       { occs.capacity(n); dirty.capacity(n); }
     Vec&  operator[](const K& idx){ return occs[idx]; }
     Vec&  lookup    (const K& idx){ if (dirty[idx]) clean(idx); return occs[idx]; }
 
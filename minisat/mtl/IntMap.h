@@ -48,6 +48,7 @@ namespace Minisat {
         void     reserve(K key)              { map.growTo(index(key)+1); }
         void     insert (K key, V val, V pad){ reserve(key, pad); operator[](key) = val; }
         void     insert (K key, V val)       { reserve(key); operator[](key) = val; }
+        void     capacity(int n)             { map.capacity(n); }   // (room for the keys of index below 'n')
 
         void     clear  (bool dispose = false) { map.clear(dispose); }
         void     moveTo (IntMap& to)           { map.moveTo(to.map); to.index = index; }
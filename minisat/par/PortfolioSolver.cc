@@ -0,0 +1,345 @@
+/******************************************************************************[PortfolioSolver.cc]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#include <thread>
+#include <vector>
+
+#include "minisat/par/PortfolioSolver.h"
+#include "minisat/utils/Options.h"
+#include "minisat/utils/System.h"
+
+using namespace Minisat;
+
+//=================================================================================================
+// Options:
+
+
+static const char* _cat = "PAR";
+
+static IntOption     opt_threads           (_cat, "threads",     "Number of solvers run in parallel", 4, IntRange(1, 1024));
+static IntOption     opt_share_lbd         (_cat, "share-lbd",   "Share learnt clauses with at most this LBD", 4, IntRange(0, INT32_MAX));
+static IntOption     opt_share_size        (_cat, "share-size",  "Share learnt clauses with at most this many literals", 16, IntRange(1, 1024));
+
+
+//=================================================================================================
+// ClauseRing:
+//
+// A clause occupies '2 + size' consecutive words: its size, its LBD and its literals.
+
+
+ClauseRing::ClauseRing() : data(new std::atomic<uint32_t>[capacity]), head(0), reserved(0) {}
+ClauseRing::~ClauseRing() { delete [] data; }
+
+
+void ClauseRing::push(const vec<Lit>& c, int lbd)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    uint64_t n = 2 + c.size();
+    assert(n <= capacity / 2);
+
+    // Announce the words about to be overwritten before touching them:
+    reserved.store(h + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    data[h       & mask].store(c.size(), std::memory_order_relaxed);
+    data[(h + 1) & mask].store(lbd,      std::memory_order_relaxed);
+    for (int i = 0; i < c.size(); i++)
+        data[(h + 2 + i) & mask].store(toInt(c[i]), std::memory_order_relaxed);
+
+    head.store(h + n, std::memory_order_release);
+}
+
+
+bool ClauseRing::pop(uint64_t& pos, vec<Lit>& c, int& lbd) const
+{
+    uint64_t h = head.load(std::memory_order_acquire);
+    if (pos >= h)
+        return false;
+    else if (h - pos > capacity){
+        // Overrun by the producer:
+        pos = h;
+        return false; }
+
+    uint32_t size = data[pos & mask].load(std::memory_order_relaxed);
+    lbd = data[(pos + 1) & mask].load(std::memory_order_relaxed);
+    c.clear();
+    if (size <= capacity / 2)
+        for (uint32_t i = 0; i < size; i++)
+            c.push(toLit(data[(pos + 2 + i) & mask].load(std::memory_order_relaxed)));
+
+    // Drop the clause if the producer may have overwritten it while it was copied:
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (size > capacity / 2 || reserved.load(std::memory_order_relaxed) > pos + capacity){
+        pos = head.load(std::memory_order_acquire);
+        return false; }
+
+    pos += 2 + size;
+    return true;
+}
+
+
+//=================================================================================================
+// Worker -- a solver exchanging learnt clauses with the other workers of a portfolio:
+
+
+class PortfolioSolver::Worker : public Solver {
+ public:
+    Worker(PortfolioSolver& p, int i);
+
+    PortfolioSolver& portfolio;
+    int              index;
+    ClauseRing       outbox;          // Clauses learnt by this worker worth sharing.
+    vec<uint64_t>    inbox_pos;       // Read position in the 'outbox' of every worker.
+    vec<Lit>         import_tmp;
+    uint64_t         exported, imported;
+
+ protected:
+    void exportLearnt (const vec<Lit>& c, int lbd);
+    bool importLearnts();
+};
+
+
+// Each worker gets its own random seed. On top of that the workers cycle through different restart
+// policies, decision heuristics and phase handling:
+PortfolioSolver::Worker::Worker(PortfolioSolver& p, int i) :
+    portfolio(p), index(i), exported(0), imported(0)
+{
+    share_learnts = true;
+    random_seed += i * 1009;
+    switch (i % 4){
+    case 0: break;                                                       // (default configuration)
+    case 1: ema_restart    = true; vmtf_mode = 1;              break;    // Glucose restarts, VMTF.
+    case 2: stable_enabled = true;                             break;    // Stable mode, target phases and rephasing.
+    case 3: luby_restart   = false; phase_saving = 1;          break;    // Geometric restarts, limited phase saving.
+    }
+    if (i >= 4){
+        rnd_init_act    = true;
+        random_var_freq = 0.005; }
+}
+
+
+void PortfolioSolver::Worker::exportLearnt(const vec<Lit>& c, int lbd)
+{
+    if (c.size() <= portfolio.share_size && (c.size() == 1 || lbd <= portfolio.share_lbd)){
+        outbox.push(c, lbd);
+        exported++; }
+}
+
+
+bool PortfolioSolver::Worker::importLearnts()
+{
+    int lbd;
+    inbox_pos.growTo(portfolio.workers.size(), 0);
+    for (int i = 0; i < portfolio.workers.size(); i++){
+        if (i == index) continue;
+        while (portfolio.workers[i]->outbox.pop(inbox_pos[i], import_tmp, lbd)){
+            imported++;
+            if (!addLearnt_(import_tmp, lbd))
+                return false;
+        }
+    }
+    return true;
+}
+
+
+//=================================================================================================
+// Constructor/Destructor:
+
+
+PortfolioSolver::PortfolioSolver() :
+    verbosity  (0)
+  , share_lbd  (opt_share_lbd)
+  , share_size (opt_share_size)
+  , winner_    (-1)
+  , ok         (true)
+{
+    for (int i = 0; i < opt_threads; i++)
+        workers.push(new Worker(*this, i));
+}
+
+
+PortfolioSolver::~PortfolioSolver()
+{
+    for (int i = 0; i < workers.size(); i++)
+        delete workers[i];
+}
+
+
+//=================================================================================================
+// Problem specification:
+
+
+Var PortfolioSolver::newVar(lbool upol, bool dvar)
+{
+    Var v = var_Undef;
+    for (int i = 0; i < workers.size(); i++)
+        v = workers[i]->newVar(upol, dvar);
+    return v;
+}
+
+
+void PortfolioSolver::reserveVars(int n)
+{
+    for (int i = 0; i < workers.size(); i++)
+        workers[i]->reserveVars(n);
+}
+
+
+bool PortfolioSolver::addClause(const vec<Lit>& ps)
+{
+    ps.copyTo(add_tmp);
+    return addClause_(add_tmp);
+}
+
+
+bool PortfolioSolver::addClause_(vec<Lit>& ps)
+{
+    vec<Lit> c;
+    for (int i = 0; i < workers.size(); i++){
+        ps.copyTo(c);
+        if (!workers[i]->addClause_(c))
+            ok = false;
+    }
+    return ok;
+}
+
+
+void PortfolioSolver::reserveOriginalIds(uint64_t n)
+{
+    for (int i = 0; i < workers.size(); i++)
+        workers[i]->reserveOriginalIds(n);
+}
+
+
+bool PortfolioSolver::simplify()
+{
+    for (int i = 0; i < workers.size(); i++)
+        if (!workers[i]->simplify())
+            ok = false;
+    return ok;
+}
+
+
+//=================================================================================================
+// Solving:
+
+
+void PortfolioSolver::run(int i, const vec<Lit>& assumps)
+{
+    results[i] = workers[i]->solveLimited(assumps);
+
+    // The first answer stops the others:
+    int none = -1;
+    if (results[i] != l_Undef && winner_.compare_exchange_strong(none, i))
+        for (int j = 0; j < workers.size(); j++)
+            if (j != i)
+                workers[j]->interrupt();
+}
+
+
+lbool PortfolioSolver::solveLimited(const vec<Lit>& assumps)
+{
+    model.clear();
+    conflict.clear();
+    if (!ok) return l_False;
+
+    winner_ = -1;
+    results.clear();
+    results.growTo(workers.size(), l_Undef);
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < workers.size(); i++)
+        threads.push_back(std::thread(&PortfolioSolver::run, this, i, std::cref(assumps)));
+    run(0, assumps);
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    for (int i = 0; i < workers.size(); i++)
+        workers[i]->clearInterrupt();
+
+    if (winner_ < 0)
+        return l_Undef;
+
+    Worker& w      = *workers[winner_];
+    lbool   status = results[winner_];
+    if (status == l_True)
+        w.model.copyTo(model);
+    else if (!w.okay())
+        ok = false;
+    else
+        for (int i = 0; i < w.conflict.size(); i++)
+            conflict.insert(w.conflict[i]);
+
+    return status;
+}
+
+
+void PortfolioSolver::interrupt()
+{
+    for (int i = 0; i < workers.size(); i++)
+        workers[i]->interrupt();
+}
+
+
+void PortfolioSolver::clearInterrupt()
+{
+    for (int i = 0; i < workers.size(); i++)
+        workers[i]->clearInterrupt();
+}
+
+
+//=================================================================================================
+// Read state:
+
+
+int PortfolioSolver::nVars() const
+{
+    return workers[0]->nVars();
+}
+
+
+int PortfolioSolver::nClauses() const
+{
+    return workers[0]->nClauses();
+}
+
+
+void PortfolioSolver::printStats() const
+{
+    uint64_t conflicts = 0, decisions = 0, propagations = 0;
+
+    printf("===============================[ Worker Statistics ]===========================\n");
+    printf("| Worker |  Restarts  Conflicts   Decisions Propagations | Exported  Imported |\n");
+    printf("===============================================================================\n");
+    for (int i = 0; i < workers.size(); i++){
+        const Worker& w = *workers[i];
+        printf("| %4d%s | %9" PRIu64 " %10" PRIu64 " %11" PRIu64 " %12" PRIu64 " | %8" PRIu64 " %9" PRIu64 " |\n",
+               i, i == winner_ ? " *" : "  ", w.starts, w.conflicts, w.decisions, w.propagations, w.exported, w.imported);
+        conflicts    += w.conflicts;
+        decisions    += w.decisions;
+        propagations += w.propagations;
+    }
+    printf("===============================================================================\n");
+
+    double cpu_time = cpuTime();
+    double mem_used = memUsedPeak();
+    printf("conflicts             : %-12" PRIu64 "   (%.0f /sec)\n", conflicts   , conflicts   /cpu_time);
+    printf("decisions             : %-12" PRIu64 "   (%.0f /sec)\n", decisions   , decisions   /cpu_time);
+    printf("propagations          : %-12" PRIu64 "   (%.0f /sec)\n", propagations, propagations/cpu_time);
+    if (mem_used != 0) printf("Memory used           : %.2f MB\n", mem_used);
+    printf("CPU time              : %g s\n", cpu_time);
+}
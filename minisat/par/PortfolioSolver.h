@@ -0,0 +1,131 @@
+/*******************************************************************************[PortfolioSolver.h]
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and
+associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT
+NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT
+OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+**************************************************************************************************/
+
+#ifndef Minisat_PortfolioSolver_h
+#define Minisat_PortfolioSolver_h
+
+#include <atomic>
+
+#include "minisat/core/Solver.h"
+
+
+namespace Minisat {
+
+//=================================================================================================
+// ClauseRing -- a ring buffer of shared clauses with one producer and any number of consumers:
+//
+// The producer never waits. A consumer that falls more than the capacity behind skips ahead and
+// loses the clauses in between, and a clause that is overwritten while it is being copied is
+// dropped (it is validated against the producer's reservation counter, as in a seqlock).
+
+
+class ClauseRing {
+    enum { capacity = 1 << 16, mask = capacity - 1 };   // (in words)
+
+    std::atomic<uint32_t>* data;
+    std::atomic<uint64_t>  head;        // Number of words published.
+    std::atomic<uint64_t>  reserved;    // Number of words published or being written.
+
+    // Don't allow copying:
+    ClauseRing(const ClauseRing&);
+    ClauseRing& operator=(const ClauseRing&);
+
+ public:
+    ClauseRing();
+   ~ClauseRing();
+
+    void     push (const vec<Lit>& c, int lbd);                  // Only the owner may push.
+    bool     pop  (uint64_t& pos, vec<Lit>& c, int& lbd) const;  // Read the clause at 'pos' (if any) and advance 'pos'.
+};
+
+
+//=================================================================================================
+// PortfolioSolver -- runs several diversified solvers on the same problem in parallel:
+
+
+class PortfolioSolver {
+ public:
+    // Constructor/Destructor:
+    //
+    PortfolioSolver();
+    ~PortfolioSolver();
+
+    // Problem specification:
+    //
+    Var     newVar    (lbool upol = l_Undef, bool dvar = true); // Add a new variable to every worker.
+    void    reserveVars(int n);                                 // (see 'Solver::reserveVars()')
+    bool    addClause (const vec<Lit>& ps);                     // Add a clause to every worker.
+    bool    addClause_(      vec<Lit>& ps);                     // Add a clause to every worker; changes the passed vector 'ps'.
+    void    reserveOriginalIds(uint64_t n);                     // (see 'Solver::reserveOriginalIds()')
+
+    // Solving:
+    //
+    bool    simplify     ();                        // Removes already satisfied clauses.
+    bool    solve        (const vec<Lit>& assumps); // Search for a model that respects a given set of assumptions.
+    lbool   solveLimited (const vec<Lit>& assumps); // Search for a model that respects a given set of assumptions (With resource constraints).
+    bool    solve        ();                        // Search without assumptions.
+    bool    okay         () const;                  // FALSE means solver is in a conflicting state
+    void    interrupt    ();                        // Trigger a (potentially asynchronous) interruption of all workers.
+    void    clearInterrupt();                       // Clear interrupt indicator flag.
+
+    // Read state:
+    //
+    int     nVars      ()      const;       // The current number of variables.
+    int     nClauses   ()      const;       // The current number of original clauses.
+    int     nWorkers   ()      const;       // The number of solvers run in parallel.
+    int     winner     ()      const;       // The worker that answered the last call to 'solve()' (-1 if none did).
+    void    printStats ()      const;
+
+    // Extra results: (read-only member variable)
+    //
+    vec<lbool> model;             // If problem is satisfiable, this vector contains the model (if any).
+    LSet       conflict;          // If problem is unsatisfiable (possibly under assumptions),
+                                  // this vector represent the final conflict clause expressed in the assumptions.
+
+    // Mode of operation:
+    //
+    int       verbosity;
+    int       share_lbd;          // Share learnt clauses with at most this LBD.                                              (default 4)
+    int       share_size;         // Share learnt clauses with at most this many literals.                                    (default 16)
+
+ protected:
+    class Worker;
+
+    vec<Worker*>        workers;
+    vec<lbool>          results;          // The answer of each worker in the last call to 'solve()'.
+    std::atomic<int>    winner_;
+    bool                ok;
+    vec<Lit>            add_tmp;
+
+    void     run              (int i, const vec<Lit>& assumps);  // Thread main function of worker 'i'.
+};
+
+
+//=================================================================================================
+// Implementation of inline methods:
+
+inline bool     PortfolioSolver::solve         (const vec<Lit>& assumps){ return solveLimited(assumps) == l_True; }
+inline bool     PortfolioSolver::solve         ()                    { vec<Lit> none; return solve(none); }
+inline bool     PortfolioSolver::okay          ()      const   { return ok; }
+inline int      PortfolioSolver::nWorkers      ()      const   { return workers.size(); }
+inline int      PortfolioSolver::winner        ()      const   { return winner_; }
+
+
+//=================================================================================================
+}
+
+#endif
@@ -33,6 +33,12 @@ static const char* _cat = "SIMP";
 static BoolOption   opt_use_asymm        (_cat, "asymm",        "Shrink clauses by asymmetric branching.", false);
 static BoolOption   opt_use_rcheck       (_cat, "rcheck",       "Check if a clause is already implied. (costly)", false);
 static BoolOption   opt_use_elim         (_cat, "elim",         "Perform variable elimination.", true);
+static BoolOption   opt_use_equiv        (_cat, "equiv",        "Substitute equivalent literals (cycles of binary clauses).", false);
+static BoolOption   opt_use_bva          (_cat, "bva",          "Perform bounded variable addition.", false);
+static IntOption    opt_bva_lim          (_cat, "bva-lim",      "Work limit of bounded variable addition (in millions of steps).", 100, IntRange(0, INT32_MAX));
+static BoolOption   opt_use_gates        (_cat, "gates",        "Detect AND/XOR/ITE gates to eliminate variables with fewer resolvents.", false);
+static BoolOption   opt_use_bce          (_cat, "bce",          "Remove blocked clauses (the variables of later clauses must be frozen).", false);
+static IntOption    opt_bce_occ_lim      (_cat, "bce-occ-lim",  "Do not check blocking on a literal whose negation occurs more often than this.", 100, IntRange(0, INT32_MAX));
 static IntOption    opt_grow             (_cat, "grow",         "Allow a variable elimination step to grow by a number of clauses.", 0);
 static IntOption    opt_clause_lim       (_cat, "cl-lim",       "Variables are not eliminated if it produces a resolvent with a length above this limit. -1 means no limit", 20,   IntRange(-1, INT32_MAX));
 static IntOption    opt_subsumption_lim  (_cat, "sub-lim",      "Do not check if subsumption against a clause larger than this. -1 means no limit.", 1000, IntRange(-1, INT32_MAX));
@@ -51,21 +57,34 @@ SimpSolver::SimpSolver() :
   , use_asymm          (opt_use_asymm)
   , use_rcheck         (opt_use_rcheck)
   , use_elim           (opt_use_elim)
+  , use_equiv          (opt_use_equiv)
+  , use_gates          (opt_use_gates)
+  , use_bce            (opt_use_bce)
+  , bce_occ_lim        (opt_bce_occ_lim)
+  , use_bva            (opt_use_bva)
+  , bva_lim            (opt_bva_lim)
   , extend_model       (true)
   , merges             (0)
   , asymm_lits         (0)
   , eliminated_vars    (0)
+  , substituted_vars   (0)
+  , gate_elims         (0)
+  , blocked_clauses    (0)
+  , added_vars         (0)
   , elimorder          (1)
   , use_simplification (true)
   , occurs             (ClauseDeleted(ca))
   , elim_heap          (ElimLt(n_occ))
   , bwdsub_assigns     (0)
   , n_touched          (0)
+  , inprocess_trail    (0)
+  , inprocessing       (false)
 {
     vec<Lit> dummy(1,lit_Undef);
     ca.extra_clause_field = true; // NOTE: must happen before allocating the dummy clause below.
     bwdsub_tmpunit        = ca.alloc(dummy);
     remove_satisfied      = false;
+    implicit_bins         = false; // NOTE: occurrence lists need every problem clause in the arena.
 }
 
 
@@ -90,6 +109,20 @@ Var SimpSolver::newVar(lbool upol, bool dvar) {
     return v; }
 
 
+void SimpSolver::reserveVars(int n) {
+    Solver::reserveVars(n);
+
+    frozen    .capacity(n);
+    eliminated.capacity(n);
+
+    if (use_simplification){
+        n_occ     .capacity(2*n);
+        occurs    .capacity(n);
+        touched   .capacity(n);
+    }
+}
+
+
 void SimpSolver::releaseVar(Lit l)
 {
     assert(!isEliminated(var(l)));
@@ -146,6 +179,13 @@ lbool SimpSolver::solve_(bool do_simp, bool turn_off_simp)
 
 
 bool SimpSolver::addClause_(vec<Lit>& ps)
+{
+    return addClause_(ps, originalId());
+}
+
+
+// Adds a clause that is already in the proof (an original clause or a resolvent):
+bool SimpSolver::addClause_(vec<Lit>& ps, uint64_t id)
 {
 #ifndef NDEBUG
     for (int i = 0; i < ps.size(); i++)
@@ -157,7 +197,7 @@ bool SimpSolver::addClause_(vec<Lit>& ps)
     if (use_rcheck && implied(ps))
         return true;
 
-    if (!Solver::addClause_(ps))
+    if (!Solver::addClause_(ps, id))
         return false;
 
     if (use_simplification && clauses.size() == nclauses + 1){
@@ -200,20 +240,34 @@ void SimpSolver::removeClause(CRef cr)
 }
 
 
-bool SimpSolver::strengthenClause(CRef cr, Lit l)
+// Removes 'l' from the clause 'cr'. The strengthened clause must follow by unit propagation (for LRAT,
+// over the antecedents 'hints'); it is written to the proof before the original clause is deleted.
+bool SimpSolver::strengthenClause(CRef cr, Lit l, const vec<uint64_t>& hints)
 {
     Clause& c = ca[cr];
     assert(decisionLevel() == 0);
     assert(use_simplification);
 
+    strengthen_tmp.clear();
+    for (int i = 0; i < c.size(); i++)
+        if (c[i] != l)
+            strengthen_tmp.push(c[i]);
+    if (output != NULL && lrat && locked(c))
+        unitId(var(c[0]));      // (derive the unit clause from 'c' as it is now)
+    uint64_t id = proofLemma(strengthen_tmp, hints);
+
     // FIX: this is too inefficient but would be nice to have (properly implemented)
     // if (!find(subsumption_queue, &c))
     subsumption_queue.insert(cr);
 
     if (c.size() == 2){
+        // The remaining literal becomes a unit clause:
         removeClause(cr);
-        c.strengthen(l);
+        return Solver::addClause_(strengthen_tmp, id);
     }else{
+        proofDeleted(c);
+        if (output != NULL && lrat)
+            c.id(id);
         detachClause(cr, true);
         c.strengthen(l);
         attachClause(cr);
@@ -222,7 +276,7 @@ bool SimpSolver::strengthenClause(CRef cr, Lit l)
         updateElimHeap(var(l));
     }
 
-    return c.size() == 1 ? enqueue(c[0]) && propagate() == CRef_Undef : true;
+    return true;
 }
 
 
@@ -321,10 +375,10 @@ bool SimpSolver::implied(const vec<Lit>& c)
 {
     assert(decisionLevel() == 0);
 
-    trail_lim.push(trail.size());
+    newProbeLevel();
     for (int i = 0; i < c.size(); i++)
         if (value(c[i]) == l_True){
-            cancelUntil(0);
+            cancelProbe();
             return true;
         }else if (value(c[i]) != l_False){
             assert(value(c[i]) == l_Undef);
@@ -332,7 +386,7 @@ bool SimpSolver::implied(const vec<Lit>& c)
         }
 
     bool result = propagate() != CRef_Undef;
-    cancelUntil(0);
+    cancelProbe();
     return result;
 }
 
@@ -391,7 +445,13 @@ bool SimpSolver::backwardSubsumptionCheck(bool verbose)
                 else if (l != lit_Error){
                     deleted_literals++;
 
-                    if (!strengthenClause(cs[j], ~l))
+                    // The strengthened clause is the resolvent of 'c' and the candidate on 'l':
+                    proof_hints.clear();
+                    if (output != NULL && lrat){
+                        proof_hints.push(cr == bwdsub_tmpunit ? unitId(var(l)) : c.id());
+                        proof_hints.push(ca[cs[j]].id()); }
+
+                    if (!strengthenClause(cs[j], ~l, proof_hints))
                         return false;
 
                     // Did current candidate get deleted from cs? Then check candidate at index j again:
@@ -412,7 +472,7 @@ bool SimpSolver::asymm(Var v, CRef cr)
 
     if (c.mark() || satisfied(c)) return true;
 
-    trail_lim.push(trail.size());
+    newProbeLevel();
     Lit l = lit_Undef;
     for (int i = 0; i < c.size(); i++)
         if (var(c[i]) != v && value(c[i]) != l_False)
@@ -420,13 +480,27 @@ bool SimpSolver::asymm(Var v, CRef cr)
         else
             l = c[i];
 
-    if (propagate() != CRef_Undef){
-        cancelUntil(0);
+    CRef confl = propagate();
+    if (confl != CRef_Undef){
+        proof_hints.clear();
+        if (output != NULL && lrat){
+            if (var(l) != v){
+                // A literal false at level 0 is removed:
+                proof_hints.push(unitId(var(l)));
+                proof_hints.push(c.id());
+            }else{
+                strengthen_tmp.clear();
+                for (int i = 0; i < c.size(); i++)
+                    if (c[i] != l)
+                        strengthen_tmp.push(c[i]);
+                lratChain(confl, strengthen_tmp, proof_hints); } }
+
+        cancelProbe();
         asymm_lits++;
-        if (!strengthenClause(cr, l))
+        if (!strengthenClause(cr, l, proof_hints))
             return false;
     }else
-        cancelUntil(0);
+        cancelProbe();
 
     return true;
 }
@@ -456,6 +530,14 @@ static void mkElimClause(vec<uint32_t>& elimclauses, Lit x)
 }
 
 
+static void mkElimClause(vec<uint32_t>& elimclauses, Lit x, Lit y)
+{
+    elimclauses.push(toInt(x));
+    elimclauses.push(toInt(y));
+    elimclauses.push(2);
+}
+
+
 static void mkElimClause(vec<uint32_t>& elimclauses, Var v, Clause& c)
 {
     int first = elimclauses.size();
@@ -482,9 +564,195 @@ static void mkElimClause(vec<uint32_t>& elimclauses, Var v, Clause& c)
 
 
 
+// Moves the clause 'cs[i]' to the front part 'cs[0..n)' (the gate clauses).
+static void moveToFront(vec<CRef>& cs, int& n, int i)
+{
+    CRef tmp = cs[i];
+    cs[i]    = cs[n];
+    cs[n++]  = tmp;
+}
+
+
+// Looks for a gate 'l = a1 & ... & ak' among the clauses 'lcls' containing 'l' and 'ncls' containing
+// '~l': the binaries '(~l \/ ai)' and the clause '(l \/ ~a1 \/ ... \/ ~ak)'. With k = 1, this is an
+// equivalence. The gate clauses are moved to the front of 'lcls' and 'ncls'.
+bool SimpSolver::findAndGate(Lit l, vec<CRef>& lcls, vec<CRef>& ncls, int& l_gates, int& n_gates)
+{
+    for (int i = 0; i < ncls.size(); i++){
+        const Clause& c = ca[ncls[i]];
+        if (c.size() == 2){
+            Lit a = c[0] == ~l ? c[1] : c[0];
+            seen[var(a)] = 1 + sign(a); }
+    }
+
+    int found = -1;
+    for (int i = 0; found == -1 && i < lcls.size(); i++){
+        const Clause& c = ca[lcls[i]];
+        int k = 0;
+        while (k < c.size() && (c[k] == l || seen[var(c[k])] == 1 + sign(~c[k])))
+            k++;
+        if (k == c.size())
+            found = i;
+    }
+
+    for (int i = 0; i < ncls.size(); i++){
+        const Clause& c = ca[ncls[i]];
+        if (c.size() == 2){
+            Lit a = c[0] == ~l ? c[1] : c[0];
+            seen[var(a)] = 0;
+            if (found != -1 && find(ca[lcls[found]], ~a))
+                moveToFront(ncls, n_gates, i); }
+    }
+    if (found != -1)
+        moveToFront(lcls, l_gates, found);
+
+    return found != -1;
+}
+
+
+// Returns the signs of the literals of 'd' as a bit mask over the positions of their variables in
+// 'xs', or -1 if 'd' is not a clause over exactly the variables 'xs'.
+static int signMask(const Clause& d, const Var* xs, int n)
+{
+    if (d.size() != n)
+        return -1;
+    int m = 0;
+    for (int k = 0; k < n; k++){
+        int x = 0;
+        while (x < n && xs[x] != var(d[k]))
+            x++;
+        if (x == n)
+            return -1;
+        m |= sign(d[k]) << x;
+    }
+    return m;
+}
+
+
+// Looks for a gate 'v = x1 ^ ... ^ xk' with k = 2 or 3: all 2^k clauses over 'v' and the 'xi' with
+// the same parity of negative literals, where 'pos' and 'neg' are the occurrences of 'v' (which need
+// not be known here). The gate clauses are moved to the front of 'pos' and 'neg'.
+bool SimpSolver::findXorGate(vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates)
+{
+    for (int i = 0; i < pos.size(); i++){
+        const Clause& c = ca[pos[i]];
+        int           n = c.size();
+        if (n < 3 || n > 4)
+            continue;
+
+        // Collect the sign patterns with the parity of 'c':
+        Var      xs[4];
+        int      parity = 0;
+        uint32_t have   = 0;
+        for (int k = 0; k < n; k++){
+            xs[k]   = var(c[k]);
+            parity ^= sign(c[k]); }
+        for (int side = 0; side < 2; side++){
+            const vec<CRef>& cs = side == 0 ? pos : neg;
+            for (int j = 0; j < cs.size(); j++){
+                int m = signMask(ca[cs[j]], xs, n);
+                int p = 0;
+                for (int b = m; b > 0; b &= b - 1)
+                    p ^= 1;
+                if (m >= 0 && p == parity)
+                    have |= 1u << m;
+            }
+        }
+
+        int count = 0;
+        for (uint32_t h = have; h != 0; h &= h - 1)
+            count++;
+        if (count < 1 << (n - 1))
+            continue;
+
+        // Move one clause of each pattern to the front:
+        for (int side = 0; side < 2; side++){
+            vec<CRef>& cs    = side == 0 ? pos : neg;
+            int&       gates = side == 0 ? pos_gates : neg_gates;
+            for (int j = 0; j < cs.size(); j++){
+                int m = signMask(ca[cs[j]], xs, n);
+                if (m >= 0 && (have & (1u << m))){
+                    have &= ~(1u << m);
+                    moveToFront(cs, gates, j); }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+
+// Finds the ternary clause '(v \/ x \/ y)' (for some 'v') in 'cs', or returns -1.
+static int findTernary(const ClauseAllocator& ca, const vec<CRef>& cs, Lit x, Lit y)
+{
+    for (int i = 0; i < cs.size(); i++){
+        const Clause& c = ca[cs[i]];
+        if (c.size() == 3 && find(c, x) && find(c, y))
+            return i;
+    }
+    return -1;
+}
+
+
+// Looks for a gate 'v = c ? t : e': the clauses '(~v \/ ~c \/ t)', '(~v \/ c \/ e)', '(v \/ ~c \/ ~t)'
+// and '(v \/ c \/ ~e)'. The gate clauses are moved to the front of 'pos' and 'neg'.
+bool SimpSolver::findIteGate(Var v, vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates)
+{
+    for (int i = 0; i < neg.size(); i++){
+        const Clause& c1 = ca[neg[i]];
+        if (c1.size() != 3)
+            continue;
+        for (int j = i + 1; j < neg.size(); j++){
+            const Clause& c2 = ca[neg[j]];
+            if (c2.size() != 3)
+                continue;
+
+            // Find the condition: a literal '~c' of the first clause whose negation is in the second:
+            for (int k = 0; k < 3; k++){
+                Lit nc = c1[k];
+                if (var(nc) == v || !find(c2, ~nc))
+                    continue;
+                Lit t = c1[0] != nc && var(c1[0]) != v ? c1[0] : c1[1] != nc && var(c1[1]) != v ? c1[1] : c1[2];
+                Lit e = c2[0] != ~nc && var(c2[0]) != v ? c2[0] : c2[1] != ~nc && var(c2[1]) != v ? c2[1] : c2[2];
+                int p1 = findTernary(ca, pos, nc, ~t);
+                int p2 = findTernary(ca, pos, ~nc, ~e);
+                if (p1 == -1 || p2 == -1 || p1 == p2)
+                    continue;
+
+                // (the indices change as the clauses are moved)
+                CRef gn[2] = { neg[i], neg[j] }, gp[2] = { pos[p1], pos[p2] };
+                for (int g = 0; g < 2; g++){
+                    int x = 0;
+                    while (neg[x] != gn[g]) x++;
+                    moveToFront(neg, neg_gates, x);
+                    x = 0;
+                    while (pos[x] != gp[g]) x++;
+                    moveToFront(pos, pos_gates, x);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+// Finds a gate defining 'v' among its clauses 'pos' and 'neg' and moves the gate clauses to the front
+// of these lists ('pos_gates' and 'neg_gates' of them). Only the resolvents of a gate clause with a
+// non-gate clause are needed to eliminate 'v' then: the resolvents of two gate clauses are
+// tautologies, and those of two non-gate clauses are implied by the others.
+bool SimpSolver::findGate(Var v, vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates)
+{
+    pos_gates = neg_gates = 0;
+    return findAndGate( mkLit(v), pos, neg, pos_gates, neg_gates)
+        || findAndGate(~mkLit(v), neg, pos, neg_gates, pos_gates)
+        || findXorGate(pos, neg, pos_gates, neg_gates)
+        || findIteGate(v, pos, neg, pos_gates, neg_gates);
+}
+
 bool SimpSolver::eliminateVar(Var v)
 {
-    assert(!frozen[v]);
+    assert(!isFrozen(v));
     assert(!isEliminated(v));
     assert(value(v) == l_Undef);
 
@@ -495,6 +763,10 @@ bool SimpSolver::eliminateVar(Var v)
     for (int i = 0; i < cls.size(); i++)
         (find(ca[cls[i]], mkLit(v)) ? pos : neg).push(cls[i]);
 
+    // With a gate, only the resolvents of gate clauses with non-gate clauses are produced:
+    int  pos_gates, neg_gates;
+    bool gate = use_gates && findGate(v, pos, neg, pos_gates, neg_gates);
+
     // Check wether the increase in number of clauses stays within the allowed ('grow'). Moreover, no
     // clause must exceed the limit on the maximal clause size (if it is set):
     //
@@ -503,7 +775,7 @@ bool SimpSolver::eliminateVar(Var v)
 
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, clause_size) && 
+            if ((!gate || (i < pos_gates) != (j < neg_gates)) && merge(ca[pos[i]], ca[neg[j]], v, clause_size) && 
                 (++cnt > cls.size() + grow || (clause_lim != -1 && clause_size > clause_lim)))
                 return true;
 
@@ -511,6 +783,7 @@ bool SimpSolver::eliminateVar(Var v)
     eliminated[v] = true;
     setDecisionVar(v, false);
     eliminated_vars++;
+    if (gate) gate_elims++;
 
     if (pos.size() > neg.size()){
         for (int i = 0; i < neg.size(); i++)
@@ -522,14 +795,28 @@ bool SimpSolver::eliminateVar(Var v)
         mkElimClause(elimclauses, ~mkLit(v));
     }
 
+    // Write the resolvents to the proof before their antecedents are deleted:
+    vec<Lit>& resolvent = add_tmp;
+    resolvent_ids.clear();
+    if (output != NULL)
+        for (int i = 0; i < pos.size(); i++)
+            for (int j = 0; j < neg.size(); j++)
+                if ((!gate || (i < pos_gates) != (j < neg_gates)) && merge(ca[pos[i]], ca[neg[j]], v, resolvent)){
+                    proof_hints.clear();
+                    if (lrat){
+                        proof_hints.push(ca[pos[i]].id());
+                        proof_hints.push(ca[neg[j]].id()); }
+                    resolvent_ids.push(proofLemma(resolvent, proof_hints)); }
+
     for (int i = 0; i < cls.size(); i++)
         removeClause(cls[i]); 
 
     // Produce clauses in cross product:
-    vec<Lit>& resolvent = add_tmp;
+    int k = 0;
     for (int i = 0; i < pos.size(); i++)
         for (int j = 0; j < neg.size(); j++)
-            if (merge(ca[pos[i]], ca[neg[j]], v, resolvent) && !addClause_(resolvent))
+            if ((!gate || (i < pos_gates) != (j < neg_gates)) && merge(ca[pos[i]], ca[neg[j]], v, resolvent) &&
+                !addClause_(resolvent, output != NULL ? resolvent_ids[k++] : 0))
                 return false;
 
     // Free occurs list for this variable:
@@ -545,29 +832,67 @@ bool SimpSolver::eliminateVar(Var v)
 
 bool SimpSolver::substitute(Var v, Lit x)
 {
-    assert(!frozen[v]);
+    // (the antecedents, including the clauses defining 'v' as 'x', are up to the caller)
+    return substitute(v, x, 0, 0);
+}
+
+
+// Replaces 'v' by 'x' in the problem clauses. For LRAT, 'pos_id' and 'neg_id' are the IDs of the
+// binaries '(~v \/ x)' and '(v \/ ~x)' defining 'v' as 'x', which are the antecedents of the new
+// clauses. The definition is kept in 'elimclauses' to extend the model.
+bool SimpSolver::substitute(Var v, Lit x, uint64_t pos_id, uint64_t neg_id)
+{
+    assert(!isFrozen(v));
     assert(!isEliminated(v));
     assert(value(v) == l_Undef);
+    assert(var(x) != v);
 
     if (!ok) return false;
 
     eliminated[v] = true;
     setDecisionVar(v, false);
+    substituted_vars++;
+    mkElimClause(elimclauses,  mkLit(v), ~x);
+    mkElimClause(elimclauses, ~mkLit(v),  x);
     const vec<CRef>& cls = occurs.lookup(v);
     
     vec<Lit>& subst_clause = add_tmp;
     for (int i = 0; i < cls.size(); i++){
-        Clause& c = ca[cls[i]];
+        Clause& c    = ca[cls[i]];
+        bool    drop = satisfied(c);
 
         subst_clause.clear();
+        proof_hints.clear();
         for (int j = 0; j < c.size(); j++){
             Lit p = c[j];
-            subst_clause.push(var(p) == v ? x ^ sign(p) : p);
+            if (var(p) == v){
+                subst_clause.push(x ^ sign(p));
+                if (output != NULL && lrat && pos_id != 0){
+                    proof_hints.push(sign(p) ? neg_id : pos_id);
+                    proof_hints.push(c.id()); }
+            }else
+                subst_clause.push(p);
         }
 
+        // Remove duplicates; a tautology is dropped:
+        sort(subst_clause);
+        Lit prev = lit_Undef;
+        int j, k;
+        for (j = k = 0; j < subst_clause.size(); j++)
+            if (subst_clause[j] == ~prev)
+                drop = true;
+            else if (subst_clause[j] != prev)
+                subst_clause[k++] = prev = subst_clause[j];
+        subst_clause.shrink(j - k);
+
+        if (drop){
+            removeClause(cls[i]);
+            continue; }
+
+        uint64_t id = proofLemma(subst_clause, proof_hints);
         removeClause(cls[i]);
 
-        if (!addClause_(subst_clause))
+        if (!addClause_(subst_clause, id))
             return ok = false;
     }
 
@@ -575,6 +900,509 @@ bool SimpSolver::substitute(Var v, Lit x)
 }
 
 
+// Applies the substitution 'equiv_repr' to the learnt clause 'ps'. Returns FALSE if the clause is to
+// be dropped: it became a tautology or has a literal assigned at level 0. For LRAT, the IDs of the
+// binaries defining the substituted literals are pushed to 'hints'.
+bool SimpSolver::substituteLearnt(vec<Lit>& ps, vec<uint64_t>& hints)
+{
+    hints.clear();
+    for (int i = 0; i < ps.size(); i++){
+        Lit p = ps[i];
+        if (equiv_repr[p] != p){
+            ps[i] = equiv_repr[p];
+            if (output != NULL && lrat)
+                hints.push(equiv_ids[p]); }
+        if (value(ps[i]) != l_Undef)
+            return false;
+    }
+
+    sort(ps);
+    Lit prev = lit_Undef;
+    int i, j;
+    for (i = j = 0; i < ps.size(); i++)
+        if (ps[i] == ~prev)
+            return false;
+        else if (ps[i] != prev)
+            ps[j++] = prev = ps[i];
+    ps.shrink(i - j);
+    return true;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  substituteEquivalences : ()  ->  [bool]
+|  
+|  Description:
+|    Finds the strongly connected components of the implication graph of the binary problem clauses
+|    (Tarjan's algorithm), whose literals are all equivalent, and substitutes one representative for
+|    the other literals of each component in the problem clauses and in the learnt clauses. Frozen
+|    variables are preferred as representatives (and never substituted). A component containing both
+|    literals of a variable makes them failed. Returns FALSE if the problem is unsatisfiable.
+|________________________________________________________________________________________________@*/
+bool SimpSolver::substituteEquivalences()
+{
+    assert(use_simplification);
+    assert(decisionLevel() == 0);
+    if (!ok) return false;
+    if (nVars() == 0) return true;
+
+    // Build the graph as adjacency arrays: a binary '(p \/ q)' gives the edges '~p -> q' and '~q -> p'.
+    int      n = 2*nVars();
+    vec<int> first(n+1, 0);
+    vec<Lit> succ;
+    for (int pass = 0; pass < 2; pass++){
+        for (int i = 0; i < clauses.size(); i++){
+            const Clause& c = ca[clauses[i]];
+            if (c.mark() || c.learnt() || c.size() != 2 || value(c[0]) != l_Undef || value(c[1]) != l_Undef)
+                continue;
+            if (pass == 0)
+                first[toInt(~c[0])+1]++, first[toInt(~c[1])+1]++;
+            else{
+                succ[first[toInt(~c[0])]++] = c[1];
+                succ[first[toInt(~c[1])]++] = c[0]; }
+        }
+        if (pass == 0){
+            for (int i = 0; i < n; i++)
+                first[i+1] += first[i];
+            if (first[n] == 0)
+                return true;
+            succ.growTo(first[n]);
+        }else{
+            // (the second pass advanced each start to the next one)
+            for (int i = n; i > 0; i--)
+                first[i] = first[i-1];
+            first[0] = 0; }
+    }
+
+    // Tarjan's algorithm, iteratively. Each component gets its representative in 'repr', which is
+    // the negation of the representative of the dual component, if that was found first:
+    vec<int>  dfs_num(n, -1), low(n, 0), dfs_next;
+    vec<char> on_stack(n, 0);
+    vec<Lit>  repr(n, lit_Undef), stack, dfs, failed;
+    int       count = 0;
+    for (int root = 0; root < n; root++){
+        if (dfs_num[root] != -1 || first[root] == first[root+1] || value(toLit(root)) != l_Undef)
+            continue;
+
+        dfs_num[root] = low[root] = count++;
+        stack.push(toLit(root)); on_stack[root] = 1;
+        dfs.push(toLit(root)); dfs_next.push(first[root]);
+        while (dfs.size() > 0){
+            int u = toInt(dfs.last());
+            if (dfs_next.last() < first[u+1]){
+                int w = toInt(succ[dfs_next.last()++]);
+                if (dfs_num[w] == -1){
+                    dfs_num[w] = low[w] = count++;
+                    stack.push(toLit(w)); on_stack[w] = 1;
+                    dfs.push(toLit(w)); dfs_next.push(first[w]);
+                }else if (on_stack[w] && dfs_num[w] < low[u])
+                    low[u] = dfs_num[w];
+                continue; }
+
+            dfs.pop(); dfs_next.pop();
+            if (dfs.size() > 0 && low[u] < low[toInt(dfs.last())])
+                low[toInt(dfs.last())] = low[u];
+            if (low[u] != dfs_num[u])
+                continue;
+
+            // Pop the component of 'u':
+            int  start = stack.size();
+            do start--; while (stack[start] != toLit(u));
+            Lit  r     = lit_Undef;
+            bool contradictory = false;
+            for (int i = start; i < stack.size(); i++){
+                Lit l = stack[i];
+                on_stack[toInt(l)] = 0;
+                contradictory |= seen[var(l)];
+                seen[var(l)] = 1;
+                if (repr[toInt(~l)] != lit_Undef)
+                    r = ~repr[toInt(~l)];
+            }
+            for (int i = start; i < stack.size(); i++)
+                seen[var(stack[i])] = 0;
+
+            if (contradictory)
+                failed.push(toLit(u));
+            else if (stack.size() - start > 1){
+                if (r == lit_Undef)
+                    for (int i = start; i < stack.size(); i++){
+                        Lit l = stack[i];
+                        if (r == lit_Undef || (isFrozen(var(l)) && !isFrozen(var(r))) || (isFrozen(var(l)) == isFrozen(var(r)) && var(l) < var(r)))
+                            r = l; }
+                for (int i = start; i < stack.size(); i++)
+                    repr[toInt(stack[i])] = r;
+            }
+            stack.shrink(stack.size() - start);
+        }
+    }
+
+    // A literal implying its negation fails when probed:
+    for (int i = 0; i < failed.size(); i++)
+        if (value(failed[i]) == l_Undef){
+            newProbeLevel();
+            uncheckedEnqueue(failed[i]);
+            CRef confl = propagate();
+            if (confl == CRef_Undef)
+                cancelProbe();
+            else if (!probeUnit(failed[i], confl))
+                return false;
+        }
+
+    // Substitute the problem clauses. The binaries defining a variable as its representative are
+    // written to the proof first; for LRAT, their antecedents are the implication chains found by
+    // probing the two literals of the variable:
+    for (Var v = 0; v < nVars(); v++){
+        equiv_repr.insert( mkLit(v),  mkLit(v));
+        equiv_repr.insert(~mkLit(v), ~mkLit(v));
+        equiv_ids .insert(~mkLit(v), 0, 0); }
+
+    vec<Var> substituted;
+    vec<Lit> def(2);
+    for (Var v = 0; v < nVars(); v++){
+        Lit p = mkLit(v);
+        Lit r = repr[toInt(p)];
+        if (r == lit_Undef || var(r) == v || isFrozen(v) || isEliminated(v) || value(v) != l_Undef || value(r) != l_Undef)
+            continue;
+
+        int s;
+        for (s = 0; s < 2; s++){
+            Lit q = p ^ s;
+            def[0] = ~q;
+            def[1] = r ^ s;
+            proof_hints.clear();
+            if (output != NULL && lrat){
+                newProbeLevel();
+                uncheckedEnqueue(q);
+                CRef confl = propagate();
+                if (confl != CRef_Undef){
+                    if (!probeUnit(q, confl))
+                        return false;
+                    break; }
+                assert(value(def[1]) == l_True);
+                lratChain(reason(var(def[1])), def, proof_hints);
+                cancelProbe();
+            }
+            equiv_ids[q] = proofLemma(def, proof_hints);
+        }
+        if (s < 2){
+            if (s == 1){
+                def[0] = ~p; def[1] = r;
+                proofDeleted(def, equiv_ids[p]); }
+            continue; }
+
+        if (!substitute(v, r, equiv_ids[p], equiv_ids[~p]))
+            return false;
+        equiv_repr[ p] =  r;
+        equiv_repr[~p] = ~r;
+        substituted.push(v);
+    }
+
+    if (substituted.size() > 0){
+        // Rewrite the learnt clauses over substituted variables (the new ones are added at the end):
+        vec<Lit>& ps = add_tmp;
+        int       n_learnts = learnts.size();
+        for (int i = 0; i < n_learnts; i++){
+            Clause& c = ca[learnts[i]];
+            int     j = 0;
+            while (j < c.size() && equiv_repr[c[j]] == c[j])
+                j++;
+            if (c.mark() || j == c.size())
+                continue;
+
+            int      lbd = c.lbd();
+            uint64_t old = output != NULL && lrat ? c.id() : 0;
+            ps.clear();
+            for (j = 0; j < c.size(); j++)
+                ps.push(c[j]);
+            if (substituteLearnt(ps, proof_hints)){
+                if (output != NULL && lrat)
+                    proof_hints.push(old);
+                uint64_t id = proofLemma(ps, proof_hints);
+                Solver::removeClause(learnts[i]);
+                if (ps.size() == 1 ? !Solver::addClause_(ps, id) : !addLearnt_(ps, lbd, id))
+                    return false;
+            }else
+                Solver::removeClause(learnts[i]);
+        }
+        int i, j;
+        for (i = j = 0; i < learnts.size(); i++)
+            if (ca[learnts[i]].mark() != 1)
+                learnts[j++] = learnts[i];
+        learnts.shrink(i - j);
+
+        // The same for the implicit learnt binaries (which exist only without LRAT):
+        vec<Lit> bins;
+        for (int k = 0; k < n; k++){
+            Lit              p  = toLit(k);
+            vec<BinWatcher>& ws = bin_watches[p];
+            for (i = j = 0; i < ws.size(); i++){
+                Lit q = ws[i].other;
+                if (!ws[i].learnt || (equiv_repr[~p] == ~p && equiv_repr[q] == q))
+                    ws[j++] = ws[i];
+                else if (~p < q){
+                    bins.push(~p); bins.push(q);
+                    num_learnts--, learnts_literals -= 2, num_tier[tier_core]--; }
+            }
+            ws.shrink(i - j);
+        }
+        for (i = 0; i < bins.size(); i += 2){
+            ps.clear();
+            ps.push(bins[i]); ps.push(bins[i+1]);
+            bool keep = substituteLearnt(ps, proof_hints);
+            if (keep)
+                proofLemma(ps, proof_hints);
+            def[0] = bins[i]; def[1] = bins[i+1];
+            proofDeleted(def, 0);
+            if (!keep)
+                continue;
+            else if (ps.size() == 2)
+                attachBinary(ps[0], ps[1], true);
+            else if (!Solver::addClause_(ps, 0))
+                return false;
+        }
+
+        // The definitions are not needed in the proof anymore:
+        for (i = 0; i < substituted.size(); i++)
+            for (int s = 0; s < 2; s++){
+                Lit q = mkLit(substituted[i], s);
+                def[0] = ~q; def[1] = equiv_repr[q];
+                proofDeleted(def, equiv_ids[q]); }
+    }
+
+    return ok;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  blockedClauseElimination : ()  ->  [void]
+|  
+|  Description:
+|    Removes the clauses '(l \/ C)' blocked on 'l': every resolvent on 'l' is a tautology. They are
+|    stored in 'elimclauses' with 'l' first, so 'extendModel()' flips 'l' where such a clause is false.
+|    The candidates are the variables on the elimination heap (all of them at first, the touched ones
+|    when inprocessing). A frozen or observed variable (so also an assumption) does not block, as it
+|    may occur in later clauses. Deleting a clause needs no justification in the proof.
+|________________________________________________________________________________________________@*/
+void SimpSolver::blockedClauseElimination()
+{
+    assert(use_simplification);
+    assert(decisionLevel() == 0);
+
+    vec<Var>  vs;
+    vec<CRef> lcls, ncls;
+    for (int i = 0; i < elim_heap.size(); i++)
+        vs.push(elim_heap[i]);
+
+    for (int i = 0; i < vs.size() && !asynch_interrupt; i++){
+        Var v = vs[i];
+        if (isFrozen(v) || isEliminated(v) || value(v) != l_Undef)
+            continue;
+
+        for (int s = 0; s < 2; s++){
+            Lit l = mkLit(v, s);
+            if (n_occ[l] == 0 || n_occ[~l] > bce_occ_lim)
+                continue;
+
+            const vec<CRef>& cls = occurs.lookup(v);
+            lcls.clear(); ncls.clear();
+            for (int j = 0; j < cls.size(); j++)
+                (find(ca[cls[j]], l) ? lcls : ncls).push(cls[j]);
+
+            for (int j = 0; j < lcls.size(); j++){
+                const Clause& c = ca[lcls[j]];
+                for (int k = 0; k < c.size(); k++)
+                    seen[var(c[k])] = 1 + sign(c[k]);
+
+                // Each resolvent must contain a pair of complementary literals (besides 'l'):
+                int n = 0;
+                for (; n < ncls.size(); n++){
+                    const Clause& d = ca[ncls[n]];
+                    int           m = 0;
+                    while (m < d.size() && (d[m] == ~l || seen[var(d[m])] != 1 + sign(~d[m])))
+                        m++;
+                    if (m == d.size())
+                        break;
+                }
+
+                for (int k = 0; k < c.size(); k++)
+                    seen[var(c[k])] = 0;
+
+                if (n == ncls.size()){
+                    mkElimClause(elimclauses, v, ca[lcls[j]]);
+                    removeClause(lcls[j]);
+                    blocked_clauses++; }
+            }
+        }
+    }
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  boundedVariableAddition : ()  ->  [bool]
+|  
+|  Description:
+|    Replaces the 'm * n' clauses '(p_i \/ R_j)', for literals 'p_1..p_m' and clause remainders
+|    'R_1..R_n', by the 'm + n' clauses '(p_i \/ ~x)' and '(x \/ R_j)' over a new variable 'x' where
+|    this removes clauses (as in pairwise at-most-one constraints). This is the simplified BVA of
+|    Manthey, Heule and Biere: starting from the literals with the most occurrences, the set of 'p_i'
+|    is greedily extended by the literal that completes the most remainders.
+|
+|    The new variables are hidden from the model (see 'extendModel()'). The new clauses are only RAT
+|    (on 'x') and not implied by unit propagation, so nothing is done while a proof is written.
+|    As the new variables take the next indices, this is only done by the final 'eliminate(true)'
+|    before the first 'solve()': the problem must not be extended afterwards by a client that maps
+|    its variables onto 'nVars()' (as 'parse_DIMACS()' does).
+|________________________________________________________________________________________________@*/
+bool SimpSolver::boundedVariableAddition()
+{
+    assert(use_simplification);
+    assert(decisionLevel() == 0);
+    if (output != NULL)
+        return true;
+
+    Heap<Lit,BvaLt,MkIndexLit> queue((BvaLt(n_occ)));
+    for (Var v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++)
+            if (!isEliminated(v) && value(v) == l_Undef && n_occ[mkLit(v, s)] >= 3)
+                queue.insert(mkLit(v, s));
+
+    int64_t   steps = (int64_t)bva_lim * 1000000;
+    vec<char> mark;                                     // (the literals of the current clause)
+    vec<int>  count, last;                              // (of each literal, over the matches)
+    vec<Lit>  mlit, match_lit, ps;
+    vec<CRef> mcls, rows, next_cls, next_rows, match_cls;
+    vec<int>  match_row;
+
+    while (!queue.empty() && steps > 0 && !asynch_interrupt){
+        Lit l = queue.removeMin();
+        if (value(l) != l_Undef || isEliminated(var(l)) || n_occ[l] < 3)
+            continue;
+
+        mark .growTo(2*nVars(), 0);
+        count.growTo(2*nVars(), 0);
+        last .growTo(2*nVars(), -1);
+
+        // The clauses containing 'l' give the remainders. The clauses of each remainder 'R_j' are kept
+        // in the row 'rows[j*m..(j+1)*m)', one for each literal in 'mlit':
+        mlit.clear();
+        mlit.push(l);
+        mcls.clear();
+        const vec<CRef>& cs = occurs.lookup(var(l));
+        for (int i = 0; i < cs.size(); i++)
+            if (find(ca[cs[i]], l))
+                mcls.push(cs[i]);
+        mcls.copyTo(rows);
+
+        while (steps > 0){
+            // Find the clauses '(p \/ R_j)' through the literal of 'R_j' with the fewest occurrences:
+            match_lit.clear(); match_cls.clear(); match_row.clear();
+            for (int j = 0; j < mcls.size(); j++){
+                const Clause& c    = ca[mcls[j]];
+                Lit           lmin = lit_Undef;
+                for (int k = 0; k < c.size(); k++){
+                    mark[toInt(c[k])] = 1;
+                    if (c[k] != l && (lmin == lit_Undef || n_occ[c[k]] < n_occ[lmin]))
+                        lmin = c[k]; }
+                mark[toInt(l)] = 2;
+
+                const vec<CRef>& ds = occurs.lookup(var(lmin));
+                steps -= ds.size();
+                for (int i = 0; i < ds.size(); i++){
+                    const Clause& d = ca[ds[i]];
+                    if (d.size() != c.size() || ds[i] == mcls[j])
+                        continue;
+                    steps -= d.size();
+                    Lit p   = lit_Undef;
+                    int out = 0, k;
+                    for (k = 0; k < d.size() && mark[toInt(d[k])] != 2; k++)
+                        if (!mark[toInt(d[k])])
+                            p = d[k], out++;
+                    if (k < d.size() || out != 1 || var(p) == var(l) || find(mlit, p))
+                        continue;
+                    match_lit.push(p);
+                    match_cls.push(ds[i]);
+                    match_row.push(j);
+                }
+                for (int k = 0; k < c.size(); k++)
+                    mark[toInt(c[k])] = 0;
+            }
+
+            // The literal completing the most remainders (each counted once):
+            Lit lmax = lit_Undef;
+            for (int i = 0; i < match_lit.size(); i++){
+                int p = toInt(match_lit[i]);
+                if (last[p] == match_row[i])
+                    continue;
+                last[p] = match_row[i];
+                if (++count[p] > (lmax == lit_Undef ? 0 : count[toInt(lmax)]))
+                    lmax = match_lit[i];
+            }
+            int m = mlit.size();
+            int n = mcls.size();
+            int c = lmax == lit_Undef ? 0 : count[toInt(lmax)];
+            for (int i = 0; i < match_lit.size(); i++)
+                count[toInt(match_lit[i])] = 0, last[toInt(match_lit[i])] = -1;
+
+            // Extend 'mlit' if this removes more clauses:
+            if (lmax == lit_Undef || (m+1)*c - (m+1) - c <= m*n - m - n)
+                break;
+            next_cls.clear();
+            next_rows.clear();
+            for (int i = 0; i < match_lit.size(); i++){
+                int j = match_row[i];
+                if (match_lit[i] != lmax || (next_cls.size() > 0 && next_cls.last() == mcls[j]))
+                    continue;
+                next_cls.push(mcls[j]);
+                for (int k = 0; k < m; k++)
+                    next_rows.push(rows[j*m + k]);
+                next_rows.push(match_cls[i]);
+            }
+            mlit.push(lmax);
+            next_cls.moveTo(mcls);
+            next_rows.moveTo(rows);
+        }
+
+        int m = mlit.size();
+        int n = mcls.size();
+        if (m < 2 || m*n - m - n <= 0)
+            continue;
+
+        // Introduce 'x' (the resolvents on 'x' are the clauses replaced):
+        Var x = newVar();
+        added.push(x);
+        added_vars++;
+        for (int i = 0; i < m; i++){
+            ps.clear();
+            ps.push(~mkLit(x));
+            ps.push(mlit[i]);
+            addClause_(ps, 0);
+        }
+        for (int j = 0; j < n; j++){
+            ps.clear();
+            ps.push(mkLit(x));
+            const Clause& c = ca[mcls[j]];
+            for (int k = 0; k < c.size(); k++)
+                if (c[k] != l)
+                    ps.push(c[k]);
+            addClause_(ps, 0);
+        }
+        for (int i = 0; i < rows.size(); i++)
+            if (ca[rows[i]].mark() == 0)
+                removeClause(rows[i]);
+
+        // The occurrences of these literals changed:
+        for (int i = 0; i < m; i++)
+            queue.update(mlit[i]);
+        queue.update(mkLit(x));
+    }
+
+    return true;
+}
+
+
 void SimpSolver::extendModel()
 {
     int i, j;
@@ -589,6 +1417,10 @@ void SimpSolver::extendModel()
         model[var(x)] = lbool(!sign(x));
     next:;
     }
+
+    // The variables introduced by the solver are not part of the user's problem:
+    for (i = 0; i < added.size(); i++)
+        model[added[i]] = l_Undef;
 }
 
 
@@ -601,7 +1433,10 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 
     // Main simplification loop:
     //
-    while (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0){
+    bool equiv_done = !use_equiv;
+    bool bce_done   = !use_bce;
+    bool bva_done   = !use_bva || !turn_off_elim || solves > 0;   // (see 'boundedVariableAddition()')
+    while (n_touched > 0 || bwdsub_assigns < trail.size() || elim_heap.size() > 0 || !bva_done){
 
         gatherTouchedClauses();
         // printf("  ## (time = %6.2f s) BWD-SUB: queue = %d, trail = %d\n", cpuTime(), subsumption_queue.size(), trail.size() - bwdsub_assigns);
@@ -609,6 +1444,18 @@ bool SimpSolver::eliminate(bool turn_off_elim)
             !backwardSubsumptionCheck(true)){
             ok = false; goto cleanup; }
 
+        // Substitute equivalent literals once, after subsumption made binaries of the clauses
+        // shortened by units (this shrinks what elimination has to work on):
+        if (!equiv_done){
+            equiv_done = true;
+            if (!substituteEquivalences() || !backwardSubsumptionCheck()){
+                ok = false; goto cleanup; } }
+
+        // Remove blocked clauses once, before elimination (this leaves fewer clauses to resolve):
+        if (!bce_done){
+            bce_done = true;
+            blockedClauseElimination(); }
+
         // Empty elim_heap and return immediately on user-interrupt:
         if (asynch_interrupt){
             assert(bwdsub_assigns == trail.size());
@@ -638,13 +1485,19 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 
             // At this point, the variable may have been set by assymetric branching, so check it
             // again. Also, don't eliminate frozen variables:
-            if (use_elim && value(elim) == l_Undef && !frozen[elim] && !eliminateVar(elim)){
+            if (use_elim && value(elim) == l_Undef && !isFrozen(elim) && !eliminateVar(elim)){
                 ok = false; goto cleanup; }
 
             checkGarbage(simp_garbage_frac);
         }
 
         assert(subsumption_queue.size() == 0);
+
+        // Bounded variable addition once elimination is done (its new clauses go around again):
+        if (!bva_done && n_touched == 0){
+            bva_done = true;
+            if (!boundedVariableAddition()){
+                ok = false; goto cleanup; } }
     }
  cleanup:
 
@@ -660,10 +1513,19 @@ bool SimpSolver::eliminate(bool turn_off_elim)
         remove_satisfied      = true;
         ca.extra_clause_field = false;
         max_simp_var          = nVars();
-
-        // Force full cleanup (this is safe and desirable since it only happens once):
+        inprocess_trail       = trail.size();
+        if (use_implicit_bins){
+            implicit_bins     = true;
+            makeBinariesImplicit(); }
+
+        // Force full cleanup (this is safe and desirable since it only happens once; inprocessing
+        // only collects the garbage when enough of it is wasted):
+        ca.free(bwdsub_tmpunit);
         rebuildOrderHeap();
-        garbageCollect();
+        if (inprocessing)
+            checkGarbage();
+        else
+            garbageCollect();
     }else{
         // Cheaper cleanup:
         checkGarbage();
@@ -672,11 +1534,154 @@ bool SimpSolver::eliminate(bool turn_off_elim)
     if (verbosity >= 1 && elimclauses.size() > 0)
         printf("|  Eliminated clauses:     %10.2f Mb                                      |\n", 
                double(elimclauses.size() * sizeof(uint32_t)) / (1024*1024));
+    if (verbosity >= 1 && substituted_vars > 0)
+        printf("|  Substituted variables:  %10d                                         |\n", substituted_vars);
+    if (verbosity >= 1 && blocked_clauses > 0)
+        printf("|  Blocked clauses:        %10d                                         |\n", blocked_clauses);
 
     return ok;
 }
 
 
+/*_________________________________________________________________________________________________
+|
+|  inprocess : ()  ->  [bool]
+|  
+|  Description:
+|    Reruns subsumption and variable elimination at a restart (see 'Solver::inprocess()') after
+|    simplification was turned off. The occurrence lists are rebuilt for the problem clauses only.
+|    The candidates are the clauses and variables touched by the units found since the last round:
+|    these are what shrank the clause set and may make new eliminations possible.
+|________________________________________________________________________________________________@*/
+bool SimpSolver::inprocess()
+{
+    // (while simplification is on, the next call to 'solve()' takes care of it; the problem clauses
+    // in the occurrence lists are left alone until then)
+    if (use_simplification){
+        if (!probe() || !vivify(false))
+            return false;
+        simpDB_props = 0;
+        return simplify(); }
+
+    // Mark the variables of the problem clauses with a literal on a new unit, before these clauses
+    // are removed or shrunk by 'Solver::inprocess()':
+    if (inprocess_trail > trail.size())
+        inprocess_trail = trail.size();     // (released variables were removed from the trail)
+    for (int i = inprocess_trail; i < trail.size(); i++)
+        seen[var(trail[i])] = 1;
+
+    for (Var v = 0; v < nVars(); v++)
+        touched.insert(v, 0);
+    for (int i = 0; i < clauses.size(); i++){
+        const Clause& c = ca[clauses[i]];
+        int j = 0;
+        while (j < c.size() && !seen[var(c[j])])
+            j++;
+        if (j < c.size())
+            for (j = 0; j < c.size(); j++)
+                if (value(c[j]) == l_Undef && !touched[var(c[j])])
+                    touched[var(c[j])] = 1, n_touched++;
+    }
+    for (int i = inprocess_trail; i < trail.size(); i++){
+        Lit p = trail[i];
+        seen[var(p)] = 0;
+        for (int k = 0; k < 2; k++){
+            const vec<BinWatcher>& ws = bin_watches[k ? p : ~p];
+            for (int j = 0; j < ws.size(); j++)
+                if (!ws[j].learnt && value(ws[j].other) == l_Undef && !touched[var(ws[j].other)])
+                    touched[var(ws[j].other)] = 1, n_touched++;
+        }
+    }
+    inprocess_trail = trail.size();
+
+    if (!Solver::inprocess())
+        return false;
+    else if (n_touched == 0){
+        touched.clear(true);
+        return true; }
+
+    // Rebuild the simplification data structures (they are freed again by 'eliminate()') for the
+    // touched variables only: the occurrence lists get the problem clauses containing one of them
+    // (binaries included), which need an abstraction in their extra field. The other variables are
+    // temporarily frozen, as their occurrence lists are incomplete:
+    vec<Var> cands;
+    for (Var v = 0; v < nVars(); v++)
+        if (touched[v])
+            cands.push(v);
+    ca.extra_clause_field = true;
+    if (implicit_bins){
+        implicit_bins = false;
+        makeBinariesExplicit(cands); }
+    vec<Lit> dummy(1, lit_Undef);
+    bwdsub_tmpunit     = ca.alloc(dummy);
+    use_simplification = true;
+    remove_satisfied   = false;
+    bwdsub_assigns     = trail.size();
+
+    for (Var v = 0; v < nVars(); v++){
+        n_occ .insert( mkLit(v), 0);
+        n_occ .insert(~mkLit(v), 0);
+        occurs.init(v); }
+    vec<Lit> ps;
+    for (int i = 0; i < clauses.size(); i++){
+        CRef cr = clauses[i];
+        int  j  = 0;
+        if (ca[cr].learnt() || ca[cr].mark()) continue;     // (a forgettable clause of the external propagator)
+        while (j < ca[cr].size() && !touched[var(ca[cr][j])])
+            j++;
+        if (j == ca[cr].size()) continue;
+
+        if (!ca[cr].has_extra()){
+            // (copied with the extra field, keeping its ID)
+            const Clause& c = ca[cr];
+            uint64_t      id = c.has_id() ? c.id() : 0;
+            bool          lk = locked(c);
+            ps.clear();
+            for (j = 0; j < c.size(); j++)
+                ps.push(c[j]);
+            detachClause(cr);
+            ca[cr].mark(1);
+            ca.free(cr);
+            cr = clauses[i] = ca.alloc(ps, false, id);
+            attachClause(cr);
+            if (lk)
+                vardata[var(ps[0])].reason = cr; }
+
+        const Clause& c = ca[cr];
+        for (j = 0; j < c.size(); j++){
+            occurs[var(c[j])].push(cr);
+            n_occ[c[j]]++; }
+        subsumption_queue.insert(cr);
+    }
+
+    // Assumptions must be temporarily frozen (as in 'solve_()'):
+    vec<Var> extra_frozen;
+    for (int i = 0; i < assumptions.size(); i++)
+        if (!frozen[var(assumptions[i])]){
+            frozen[var(assumptions[i])] = 1;
+            extra_frozen.push(var(assumptions[i])); }
+    for (Var v = 0; v < nVars(); v++)
+        if (!touched[v] && !frozen[v]){
+            frozen[v] = 1;
+            extra_frozen.push(v); }
+
+    for (Var v = 0; v < nVars(); v++)
+        if (touched[v]){
+            touched[v] = 0;
+            updateElimHeap(v); }
+    n_touched = 0;
+
+    inprocessing = true;
+    bool result  = eliminate(true);
+    inprocessing = false;
+
+    for (int i = 0; i < extra_frozen.size(); i++)
+        frozen[extra_frozen[i]] = 0;
+
+    return result;
+}
+
+
 //=================================================================================================
 // Garbage Collection methods:
 
@@ -716,6 +1721,7 @@ void SimpSolver::garbageCollect()
     ClauseAllocator to(ca.size() - ca.wasted()); 
 
     to.extra_clause_field = ca.extra_clause_field; // NOTE: this is important to keep (or lose) the extra fields.
+    to.clause_ids         = ca.clause_ids;
     relocAll(to);
     Solver::relocAll(to);
     if (verbosity >= 2)
@@ -41,6 +41,7 @@ class SimpSolver : public Solver {
     //
     Var     newVar    (lbool upol = l_Undef, bool dvar = true);
     void    releaseVar(Lit l);
+    void    reserveVars(int n);
     bool    addClause (const vec<Lit>& ps);
     bool    addEmptyClause();                // Add the empty clause to the solver.
     bool    addClause (Lit p);               // Add a unit clause to the solver.
@@ -96,6 +97,12 @@ class SimpSolver : public Solver {
     bool    use_asymm;         // Shrink clauses by asymmetric branching.
     bool    use_rcheck;        // Check if a clause is already implied. Prett costly, and subsumes subsumptions :)
     bool    use_elim;          // Perform variable elimination.
+    bool    use_equiv;         // Substitute equivalent literals (found as cycles of binary clauses).
+    bool    use_gates;         // Eliminate variables defined by a gate with fewer resolvents.
+    bool    use_bce;           // Remove blocked clauses (a frozen variable does not block).
+    int     bce_occ_lim;       // Do not check blocking on a literal whose negation occurs more often than this.
+    bool    use_bva;           // Perform bounded variable addition (only in the final 'eliminate(true)' before the first 'solve()').
+    int     bva_lim;           // Work limit of bounded variable addition (in millions of steps).
     bool    extend_model;      // Flag to indicate whether the user needs to look at the full model.
 
     // Statistics:
@@ -103,6 +110,10 @@ class SimpSolver : public Solver {
     int     merges;
     int     asymm_lits;
     int     eliminated_vars;
+    int     substituted_vars;
+    int     gate_elims;
+    int     blocked_clauses;
+    int     added_vars;
 
  protected:
 
@@ -124,6 +135,12 @@ class SimpSolver : public Solver {
         //     return c_x < c_y || c_x == c_y && x < y; }
     };
 
+    struct BvaLt {
+        const LMap<int>& n_occ;
+        explicit BvaLt(const LMap<int>& no) : n_occ(no) {}
+        bool operator()(Lit x, Lit y) const { return n_occ[x] > n_occ[y]; }
+    };
+
     struct ClauseDeleted {
         const ClauseAllocator& ca;
         explicit ClauseDeleted(const ClauseAllocator& _ca) : ca(_ca) {}
@@ -146,10 +163,18 @@ class SimpSolver : public Solver {
     VMap<char>          eliminated;
     int                 bwdsub_assigns;
     int                 n_touched;
+    int                 inprocess_trail;     // Size of the trail at the end of the last round of simplification.
+    bool                inprocessing;        // Set while 'inprocess()' runs 'eliminate()' on the touched variables.
+    vec<Var>            added;               // The variables introduced by bounded variable addition (hidden from the model).
 
     // Temporaries:
     //
     CRef                bwdsub_tmpunit;
+    vec<Lit>            strengthen_tmp;
+    vec<uint64_t>       proof_hints;
+    vec<uint64_t>       resolvent_ids;
+    LMap<Lit>           equiv_repr;          // Representative of each literal substituted by 'substituteEquivalences()'.
+    LMap<uint64_t>      equiv_ids;           // LRAT ID of the binary '(~l \/ equiv_repr[l])' for each substituted 'l'.
 
     // Main internal methods:
     //
@@ -162,10 +187,23 @@ class SimpSolver : public Solver {
     bool          merge                    (const Clause& _ps, const Clause& _qs, Var v, int& size);
     bool          backwardSubsumptionCheck (bool verbose = false);
     bool          eliminateVar             (Var v);
+    bool          findGate                 (Var v, vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates);
+    bool          findAndGate              (Lit l, vec<CRef>& lcls, vec<CRef>& ncls, int& l_gates, int& n_gates);
+    bool          findXorGate              (vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates);
+    bool          findIteGate              (Var v, vec<CRef>& pos, vec<CRef>& neg, int& pos_gates, int& neg_gates);
+    bool          substitute               (Var v, Lit x, uint64_t pos_id, uint64_t neg_id);
+    bool          substituteEquivalences   ();
+    bool          substituteLearnt         (vec<Lit>& ps, vec<uint64_t>& hints);
+    bool          boundedVariableAddition  ();
+    void          blockedClauseElimination ();
     void          extendModel              ();
+    bool          inprocess                ();
+    void          setObserved              (Var v, bool b);
+    bool          isFrozen                 (Var v) const;   // Frozen by the user or observed by the external propagator.
 
+    bool          addClause_               (vec<Lit>& ps, uint64_t id);
     void          removeClause             (CRef cr);
-    bool          strengthenClause         (CRef cr, Lit l);
+    bool          strengthenClause         (CRef cr, Lit l, const vec<uint64_t>& hints);
     bool          implied                  (const vec<Lit>& c);
     void          relocAll                 (ClauseAllocator& to);
 };
@@ -176,10 +214,11 @@ class SimpSolver : public Solver {
 
 
 inline bool SimpSolver::isEliminated (Var v) const { return eliminated[v]; }
+inline bool SimpSolver::isFrozen     (Var v) const { return frozen[v] || isObserved(v); }
 inline void SimpSolver::updateElimHeap(Var v) {
     assert(use_simplification);
-    // if (!frozen[v] && !isEliminated(v) && value(v) == l_Undef)
-    if (elim_heap.inHeap(v) || (!frozen[v] && !isEliminated(v) && value(v) == l_Undef))
+    // if (!isFrozen(v) && !isEliminated(v) && value(v) == l_Undef)
+    if (elim_heap.inHeap(v) || (!isFrozen(v) && !isEliminated(v) && value(v) == l_Undef))
         elim_heap.update(v); }
 
 
@@ -190,6 +229,7 @@ inline bool SimpSolver::addClause    (Lit p, Lit q)          { add_tmp.clear();
 inline bool SimpSolver::addClause    (Lit p, Lit q, Lit r)   { add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); return addClause_(add_tmp); }
 inline bool SimpSolver::addClause    (Lit p, Lit q, Lit r, Lit s){ add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); add_tmp.push(s); return addClause_(add_tmp); }
 inline void SimpSolver::setFrozen    (Var v, bool b) { frozen[v] = (char)b; if (use_simplification && !b) { updateElimHeap(v); } }
+inline void SimpSolver::setObserved  (Var v, bool b) { assert(!b || !isEliminated(v)); Solver::setObserved(v, b); if (use_simplification && !b) { updateElimHeap(v); } }
 
 inline void SimpSolver::freezeVar(Var v){
     if (!frozen[v]){
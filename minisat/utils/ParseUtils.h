@@ -23,9 +23,24 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 
 #include <zlib.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MINISAT_PARSE_MMAP 1
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define MINISAT_PARSE_SIMD 1
+#endif
+
 #include "minisat/mtl/XAlloc.h"
 
 namespace Minisat {
@@ -62,12 +77,138 @@ public:
 
 
 //-------------------------------------------------------------------------------------------------
-// End-of-file detection functions for StreamBuffer and char*:
+// A memory mapped (uncompressed) input file:
+//
+// Where SSE2 is available, whitespace and digits are scanned 16 bytes at a time and numbers of up to
+// 8 digits are converted without a loop. 'valid()' is false if the file could not be mapped (e.g. a
+// pipe, an empty file or a platform without 'mmap()') or if it is gzipped; the caller should then
+// fall back to 'StreamBuffer'.
+
+
+class MappedBuffer {
+    const char* data;
+    const char* pos;
+    const char* end;
+
+#ifdef MINISAT_PARSE_SIMD
+    // Bit 'i' is set if byte 'i' of the 16 at 'p' is whitespace/a digit:
+    static unsigned spaceMask(const char* p) {
+        __m128i x   = _mm_loadu_si128((const __m128i*)p);
+        __m128i sp  = _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+        __m128i ctl = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(8)), _mm_cmplt_epi8(x, _mm_set1_epi8(14)));
+        return _mm_movemask_epi8(_mm_or_si128(sp, ctl)); }
+    static unsigned digitMask(const char* p) {
+        __m128i x   = _mm_loadu_si128((const __m128i*)p);
+        return _mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8('9' + 1)))); }
+#endif
+
+    static bool isSpace(char c) { return (c >= 9 && c <= 13) || c == 32; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // Don't allow copying:
+    MappedBuffer(const MappedBuffer&);
+    MappedBuffer& operator=(const MappedBuffer&);
+
+public:
+    explicit MappedBuffer(const char* file) : data(NULL), pos(NULL), end(NULL) {
+#ifdef MINISAT_PARSE_MMAP
+        int fd = open(file, O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+            void* m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED){
+                data = pos = (const char*)m;
+                end  = data + st.st_size;
+                madvise(m, st.st_size, MADV_SEQUENTIAL);
+                if (end - data >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b){
+                    // (gzip magic number)
+                    munmap(m, st.st_size);
+                    data = pos = end = NULL; }
+            }
+        }
+        close(fd);
+#else
+        (void)file;
+#endif
+    }
+    ~MappedBuffer() {
+#ifdef MINISAT_PARSE_MMAP
+        if (data != NULL) munmap((void*)data, end - data);
+#endif
+    }
+
+    bool valid       () const { return data != NULL; }
+    int  operator *  () const { return (pos >= end) ? EOF : (unsigned char)*pos; }
+    void operator ++ ()       { pos++; }
+
+    void skipWhitespace() {
+        // (usually there is a single space)
+        if (pos < end && !isSpace(*pos)) return;
+        if (pos + 1 < end && !isSpace(pos[1])){ pos++; return; }
+#ifdef MINISAT_PARSE_SIMD
+        for (; end - pos >= 16; pos += 16){
+            unsigned m = ~spaceMask(pos) & 0xffff;
+            if (m != 0){ pos += __builtin_ctz(m); return; } }
+#endif
+        while (pos < end && isSpace(*pos)) pos++; }
+
+    void skipLine() {
+        const char* nl = (const char*)memchr(pos, '\n', end - pos);
+        pos = nl != NULL ? nl + 1 : end; }
+
+    int parseInt() {
+        skipWhitespace();
+        bool neg = false;
+        if (pos < end && (*pos == '-' || *pos == '+'))
+            neg = *pos++ == '-';
+
+        // Find the end of the digits, then convert them:
+        const char* q = pos;
+#ifdef MINISAT_PARSE_SIMD
+        unsigned    m;
+        if (end - q >= 16 && (m = ~digitMask(q) & 0xffff) != 0)
+            q += __builtin_ctz(m);
+        else
+#endif
+            while (q < end && isDigit(*q)) q++;
+        if (q == pos) fprintf(stderr, "PARSE ERROR! Unexpected char: %c\n", **this), exit(3);
+
+        int val = 0;
+#ifdef MINISAT_PARSE_SIMD
+        if (q - pos <= 8 && end - pos >= 8){
+            // Up to 8 digits at once (little endian): shift out the bytes after the number (leading
+            // zeros are shifted in), then combine pairs, quadruples and octets of digits.
+            uint64_t w;
+            memcpy(&w, pos, 8);
+            w   = (w - 0x3030303030303030ULL) << (8 * (8 - (q - pos)));
+            w   = w * 10 + (w >> 8);
+            w   = ((w & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) + ((w >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >> 32;
+            val = (int)w;
+            pos = q; }
+#endif
+        for (; pos < q; pos++)
+            val = val*10 + (*pos - '0');
+        return neg ? -val : val; }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// End-of-file detection functions for StreamBuffer, MappedBuffer and char*:
 
 
 static inline bool isEof(StreamBuffer& in) { return *in == EOF;  }
+static inline bool isEof(MappedBuffer& in) { return *in == EOF;  }
 static inline bool isEof(const char*   in) { return *in == '\0'; }
 
+//-------------------------------------------------------------------------------------------------
+// Fast paths for MappedBuffer:
+
+
+static inline void skipWhitespace(MappedBuffer& in) { in.skipWhitespace(); }
+static inline void skipLine      (MappedBuffer& in) { in.skipLine(); }
+static inline int  parseInt      (MappedBuffer& in) { return in.parseInt(); }
+
 //-------------------------------------------------------------------------------------------------
 // Generic parse functions parametrized over the input-stream type.
 
@@ -2,7 +2,7 @@
 
 # Check if the user provided the required arguments
 if [ $# -lt 3 ]; then
-    echo "Usage: $0 <path_to_cnfuzz_executable> <path_to_fuzz_executable> <path_to_drup_checker>"
+    echo "Usage: $0 <path_to_cnfuzz_executable> <path_to_fuzz_executable> <path_to_drup_checker> [<path_to_lrat_checker>]"
     exit 1
 fi
 
@@ -15,6 +15,9 @@ fuzz_executable=$2
 # Path to the `drup` proof checker passed as the third parameter
 drup_checker=$3
 
+# Path to the optional `lrat` proof checker passed as the fourth parameter
+lrat_checker=$4
+
 # Check if the specified cnfuzz executable exists
 if [ ! -x "$cnfuzz_executable" ]; then
     echo "Error: Specified cnfuzz executable '$cnfuzz_executable' not found or not executable"
@@ -33,6 +36,12 @@ if [ ! -x "$drup_checker" ]; then
     exit 4
 fi
 
+# Check if the specified lrat checker exists
+if [ -n "$lrat_checker" ] && [ ! -x "$lrat_checker" ]; then
+    echo "Error: Specified lrat checker '$lrat_checker' not found or not executable"
+    exit 4
+fi
+
 # Run indefinitely
 while true; do
     cnf_file="temp.cnf"
@@ -48,12 +57,38 @@ while true; do
         exit 5
     fi
 
-    # Run the fuzz executable with cnf_file and produce proof_file
-    $fuzz_executable $cnf_file $proof_file
+    # Run the fuzz executable with cnf_file and produce proof_file (text DRUP, binary DRAT or LRAT),
+    # written either by the solver itself or by its proof thread, with or without pre- and inprocessing
+    # (and equivalence substitution and gate detection)
+    # with or without chronological backtracking, through the single-literal or batched callbacks and
+    # with or without watch-driven wake-ups and calls from within unit propagation
+    proof_format=$([ $((seed % 2)) -eq 1 ] && echo "-binary-proof")
+    proof_checker=$drup_checker
+    if [ -n "$lrat_checker" ] && [ $((seed % 3)) -eq 0 ]; then
+        proof_format="-lrat"
+        proof_checker=$lrat_checker
+    fi
+    proof_thread=$([ $(((seed / 2) % 2)) -eq 1 ] && echo "-proof-thread")
+    simp=$([ $(((seed / 4) % 2)) -eq 1 ] && echo "-simp -asymm -bce")
+    equiv=$([ -n "$simp" ] && [ $(((seed / 512) % 2)) -eq 1 ] && echo "-equiv")
+    gates=$([ -n "$simp" ] && [ $(((seed / 1024) % 2)) -eq 1 ] && echo "-gates")
+    inproc=$([ $(((seed / 8) % 2)) -eq 1 ] && echo "-inproc-int=50")
+    chrono=$([ $(((seed / 16) % 2)) -eq 1 ] && echo "-chrono=1")
+    batch=$([ $(((seed / 32) % 2)) -eq 1 ] && echo "-batch")
+    watch=$([ $(((seed / 64) % 2)) -eq 1 ] && echo "-watch")
+    ext_prop=$([ $(((seed / 128) % 2)) -eq 1 ] && echo "-ext-prop-int=$((1 + seed % 4))")
+    # Bounded variable addition is skipped while a proof is written, so it runs without a proof file
+    # (only the model is checked then, against the original clauses)
+    bva=""
+    if [ -n "$simp" ] && [ $(((seed / 256) % 2)) -eq 1 ]; then
+        bva="-bva"
+        proof_file=""
+    fi
+    $fuzz_executable $proof_format $proof_thread $simp $equiv $gates $bva $inproc $chrono $batch $watch $ext_prop $cnf_file $proof_file
     fuzz_result=$?
-    if [ $fuzz_result -eq 1 ]; then
-        # Use the drup checker to validate the proof against the original CNF
-        $drup_checker $cnf_file $proof_file > /dev/null
+    if [ $fuzz_result -eq 1 ] && [ -n "$proof_file" ]; then
+        # Use the proof checker to validate the proof against the original CNF
+        $proof_checker $cnf_file $proof_file > /dev/null
         if [ $? -ne 0 ]; then
             echo "Error: Proof validation failed (seed: $seed)"
             exit 7
@@ -1,5 +1,7 @@
 #include "minisat/utils/ParseUtils.h"
+#include "minisat/utils/Options.h"
 #include "minisat/core/Solver.h"
+#include "minisat/simp/SimpSolver.h"
 
 #include <vector>
 #include <deque>
@@ -78,11 +80,21 @@ copy_split_clauses(std::vector<std::vector<int>> clauses, float ratio) {
         std::vector<std::vector<int>>(clauses.begin() + initial_size, clauses.end())};
 }
 
-class Solver : public Minisat::Solver {
+static Minisat::BoolOption opt_simp("FUZZ", "simp", "Preprocess with the SimpSolver (variable elimination, subsumption).", false);
+static Minisat::BoolOption opt_watch("FUZZ", "watch", "Wake up the propagator only when the negation of a literal of its clauses is assigned.", false);
+static Minisat::BoolOption opt_batch("FUZZ", "batch", "Propagate and add clauses through the batched callbacks.", false);
+
+template <class S>
+class Solver : public S {
 public:
+    using S::add_tmp;
+    using S::model;
+    size_t user_vars = 0; // (the variables beyond are introduced by the solver)
+
     void maxVar(size_t var) {
+        user_vars = var;
         while (var--)
-            newVar();
+            this->newVar();
     }
     void addClause(std::vector<int> c) {
         add_tmp.clear();
@@ -90,7 +102,11 @@ public:
         for (int l : c) {
             add_tmp.push(Minisat::intToLit(l));
         }
-        addClause_(add_tmp);
+        this->addClause_(add_tmp);
+    }
+    void skipClause() {
+        // keep the LRAT clause IDs of the following clauses in file order
+        this->originalId();
     }
     void addClauses(std::vector<std::vector<int>> v) {
         for (auto& c : v) {
@@ -100,7 +116,7 @@ public:
     std::unordered_set<int> getModel() {
         std::unordered_set<int> res;
         res.reserve(model.size());
-        for (int i = 0; i < model.size(); i++) {
+        for (int i = 0; i < (int)user_vars; i++) {
             assert(model[i] != Minisat::l_Undef);
             res.insert(Minisat::LitToint(Minisat::mkLit(i, model[i] == Minisat::l_False)));
         }
@@ -119,6 +135,8 @@ public:
     std::unordered_map<int, std::vector<int>> unit_clause_map;
     int lit_explaining = 0;
 
+    std::vector<int> batch, batch_reasons;
+
 public:
     std::vector<size_t> assignment_level;
     std::vector<int> assignments;
@@ -132,19 +150,23 @@ public:
         this->clauses.assign(std::make_move_iterator(clauses.begin()), std::make_move_iterator(clauses.end()));
     }
     bool check_model_assignments(const std::vector<int>& model) {
-        assert(model.size() == assignments.size());
+        // (only the assignments of the observed variables are notified)
+        assert(model.size() >= assignments.size());
         std::unordered_set<int> model_set(model.begin(), model.end());
         std::for_each(assignments.begin(), assignments.end(), [&](int lit) { assert(model_set.count(lit)); });
         return true;
     }
 
 public:
-    virtual void notify_assignment(const std::vector<int>& lits) override {
-        assignments.insert(assignments.end(), lits.begin(), lits.end());
-        for(int lit : lits) {
-            assignment_level_map.emplace(lit, assignment_level.size());
+    virtual void notify_assignment(const int* lits, size_t size) override {
+        assignments.insert(assignments.end(), lits, lits + size);
+        for (size_t i = 0; i < size; i++) {
+            assignment_level_map.emplace(lits[i], assignment_level.size());
         }
     }
+    virtual void notify_assignment(const std::vector<int>& lits) override {
+        notify_assignment(lits.data(), lits.size());
+    }
     virtual void notify_new_decision_level() override {
         assignment_level.push_back(assignments.size());
     }
@@ -162,20 +184,28 @@ public:
         assignment_level.resize(new_level);
     }
 
+    virtual void notify_watched(const int* lits, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            assert(assignment_level_map.count(lits[i]));
+        }
+    }
+
     virtual bool cb_check_found_model(const std::vector<int>& model) override {
         assert(check_model_assignments(model));
         return clauses.empty();
     }
 
     virtual int cb_decide() { return 0; };
-    virtual int cb_propagate() {
+    // the literal propagated by the first clause under the notified assignment, or a false literal
+    // if it is falsified (or 0)
+    int front_unit() {
         if (clauses.empty()) {
             return 0;
         }
         std::vector<int>& front = clauses.front();
         size_t count_true = 0, count_false = 0, count_undef = 0;
         size_t count_false_root = 0;
-        int unit;
+        int unit, conflict = 0;
         for (int lit : front) {
             if (assignment_level_map.count(lit)) {
                 count_true++;
@@ -183,6 +213,8 @@ public:
                 count_false++;
                 if (assignment_level_map[-lit] == 0) {
                     count_false_root++;
+                } else {
+                    conflict = lit;
                 }
             } else {
                 unit = lit;
@@ -190,13 +222,50 @@ public:
             }
         }
         if (count_undef == 1 && count_false == front.size() - 1 && count_false_root != count_false) {
-            assert(unit_clause_map.count(unit) == 0);
-            unit_clause_map[unit] = std::move(front);
-            clauses.pop_front();
             return unit;
         }
+        if (count_false == front.size() && count_false_root != count_false) {
+            return conflict;
+        }
         return 0;
+    }
+    virtual int cb_propagate() {
+        int unit = front_unit();
+        if (unit != 0) {
+            assert(unit_clause_map.count(unit) == 0);
+            unit_clause_map[unit] = std::move(clauses.front());
+            clauses.pop_front();
+        }
+        return unit;
     };
+    virtual const int* cb_propagate_lits(size_t& size, const int*& reasons) override {
+        if (!opt_batch) {
+            return ExternalPropagator::cb_propagate_lits(size, reasons);
+        }
+        // the units of the first clauses (over distinct variables), with their reasons given right away
+        // or on request
+        bool eager = bp(gen);
+        batch.clear();
+        batch_reasons.clear();
+        int unit;
+        while ((unit = front_unit()) != 0 && std::find_if(batch.begin(), batch.end(), [&](int lit) { return abs(lit) == abs(unit); }) == batch.end()) {
+            assert(unit_clause_map.count(unit) == 0);
+            batch.push_back(unit);
+            if (eager) {
+                batch_reasons.insert(batch_reasons.end(), clauses.front().begin(), clauses.front().end());
+                batch_reasons.push_back(0);
+            } else {
+                unit_clause_map[unit] = std::move(clauses.front());
+            }
+            clauses.pop_front();
+            if (assignment_level_map.count(-unit)) {
+                break;  // (only the first conflict is handled)
+            }
+        }
+        size = batch.size();
+        reasons = eager ? batch_reasons.data() : nullptr;
+        return batch.data();
+    }
 
     virtual int cb_add_reason_clause_lit(int propagated_lit) {
         if (lit_explaining != propagated_lit) {
@@ -240,6 +309,16 @@ public:
             return current[current_index++];
         }
     }
+    virtual const int* cb_add_external_clause(size_t& size) override {
+        if (!opt_batch) {
+            return ExternalPropagator::cb_add_external_clause(size);
+        }
+        assert(current_index == 0);
+        batch = std::move(current);
+        current.clear();
+        size = batch.size();
+        return batch.data();
+    }
 };
 
 bool check_model(const std::vector<std::vector<int>>& clauses, const std::unordered_set<int>& model) {
@@ -252,23 +331,15 @@ bool check_model(const std::vector<std::vector<int>>& clauses, const std::unorde
     return true;
 }
 
-// usage:
-// ./fuzz
-// ./fuzz input.cnf
-// ./fuzz input.cnf output.proof
-
-int main(int argc, char** argv) {
-    // read input cnf file
-    gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
-    if (in == NULL)
-        printf("ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
-    Minisat::StreamBuffer b(in);
-    int max_var = 0;
-    std::vector<std::vector<int>> clauses = parse_DIMACS(b, max_var);
-    gzclose(in);
+// the variables of the propagator's clauses must not be eliminated
+// preprocess once and turn simplification off, as the simp front end does (inprocessing may rerun it)
+static bool preprocess(Minisat::Solver&) { return true; }
+static bool preprocess(Minisat::SimpSolver& s) { return s.eliminate(true); }
 
+template <class S>
+static int run(int argc, char** argv, std::vector<std::vector<int>> clauses, int max_var) {
     // initialize solver and propagator
-    Solver s;
+    Solver<S> s;
     s.maxVar(max_var);
     Propagator p(max_var);
     s.connect_external_propagator(&p);
@@ -276,13 +347,39 @@ int main(int argc, char** argv) {
     // open output proof file
     s.output = (argc >= 3) ? fopen(argv[2], "wb") : NULL;
 
+    // the clauses given by the propagator later on are original clauses too (LRAT clause IDs)
+    s.reserveOriginalIds(clauses.size());
+
     // split and assign clauses
-    auto [initial, rest] = copy_split_clauses(clauses, 0.1);
-    s.addClauses(std::move(initial));
+    std::vector<std::vector<int>> rest;
+    if (opt_simp) {
+        // the variables of the propagator's clauses are observed and thus not eliminated, so it only
+        // gets the clauses over the first half of the variables
+        for (const auto& c : clauses) {
+            if (std::all_of(c.begin(), c.end(), [&](int lit) { return abs(lit) <= max_var / 2; })) {
+                rest.push_back(c);
+                s.skipClause();
+            } else
+                s.addClause(c);
+        }
+    } else {
+        auto [initial, rest_] = copy_split_clauses(clauses, 0.1);
+        s.addClauses(std::move(initial));
+        rest = std::move(rest_);
+    }
+    for (const auto& c : rest)
+        for (int lit : c)
+            s.add_observed_var(abs(lit));
+    if (opt_watch) {
+        // a clause can only become unit when one of its literals becomes false
+        for (const auto& c : rest)
+            for (int lit : c)
+                s.add_watched_lit(-lit);
+    }
     p.setClauses(std::move(rest));
 
     // solve
-    bool res = s.solve();
+    bool res = preprocess(s) && s.solve();
 
     // check
     assert(!res || check_model(clauses, s.getModel()));
@@ -298,11 +395,41 @@ int main(int argc, char** argv) {
                     fprintf(s.output, "%s%s%d", (i == 0) ? "" : " ", (s.model[i] == Minisat::l_True) ? "" : "-", i + 1);
             fprintf(s.output, " 0\n");
         } else {
-            // unsat, append 0
-            fprintf(s.output, "0\n");
+            // unsat, append the empty clause
+            s.outputPrintEmptyClause();
         }
         fclose(s.output);
+        s.output = NULL;
     }
 
     return !res;
+}
+
+// usage:
+// ./fuzz
+// ./fuzz input.cnf
+// ./fuzz input.cnf output.proof
+// ./fuzz -binary-proof input.cnf output.proof
+// ./fuzz -lrat input.cnf output.proof
+// ./fuzz -simp input.cnf output.proof
+// ./fuzz -simp -bva input.cnf
+// ./fuzz -batch input.cnf output.proof
+// ./fuzz -watch input.cnf output.proof
+
+int main(int argc, char** argv) {
+    Minisat::parseOptions(argc, argv, true);
+
+    // read input cnf file
+    gzFile in = (argc == 1) ? gzdopen(0, "rb") : gzopen(argv[1], "rb");
+    if (in == NULL)
+        printf("ERROR! Could not open file: %s\n", argc == 1 ? "<stdin>" : argv[1]), exit(1);
+    Minisat::StreamBuffer b(in);
+    int max_var = 0;
+    std::vector<std::vector<int>> clauses = parse_DIMACS(b, max_var);
+    gzclose(in);
+
+    if (opt_simp)
+        return run<Minisat::SimpSolver>(argc, argv, std::move(clauses), max_var);
+    else
+        return run<Minisat::Solver>(argc, argv, std::move(clauses), max_var);
 }
\ No newline at end of file